@@ -1,4 +1,7 @@
 #include "collisions.hpp"
+#include <algorithm>
+#include <cmath>
+#include "simd.hpp"
 
 AABB ComputeAABB(glm::vec3 position, glm::vec3 size) {
     glm::vec3 halfSize = size * 0.5f;
@@ -11,34 +14,180 @@ bool CheckAABBOverlap(const AABB& a, const AABB& b) {
            (a.min.z <= b.max.z && a.max.z >= b.min.z);
 }
 
+// Kernels dos testes em lote sobre ponteiros, para as versões de um par não
+// precisarem montar um SphereBatch. "single" repete a esfera a[0] em todos os testes.
+static inline void ClearHits(uint64_t* hits, size_t count) {
+    std::fill(hits, hits + (count + 63) / 64, 0);
+}
+
+#if defined(CREATURE_SIMD_AVX2) || defined(CREATURE_SIMD_SSE2)
+static inline vfloat LoadOrSet(const float* p, size_t i, bool single) {
+    return single ? VSet(p[0]) : VLoad(p + i);
+}
+
+static inline void StoreHits(uint64_t* hits, size_t i, vfloat hit) {
+    hits[i >> 6] |= (uint64_t)VMoveMask(hit) << (i & 63);
+}
+#endif
+
+static void SphereSphereKernel(const float* ax, const float* ay, const float* az, const float* ar, bool single,
+                               const float* bx, const float* by, const float* bz, const float* br,
+                               size_t count, uint64_t* hits) {
+    ClearHits(hits, count);
+    size_t i = 0;
+#if defined(CREATURE_SIMD_AVX2) || defined(CREATURE_SIMD_SSE2)
+    for (; i + LANES <= count; i += LANES) {
+        vfloat dx = VSub(LoadOrSet(ax, i, single), VLoad(bx + i));
+        vfloat dy = VSub(LoadOrSet(ay, i, single), VLoad(by + i));
+        vfloat dz = VSub(LoadOrSet(az, i, single), VLoad(bz + i));
+        vfloat r = VAdd(LoadOrSet(ar, i, single), VLoad(br + i));
+        vfloat d2 = VAdd(VAdd(VMul(dx, dx), VMul(dy, dy)), VMul(dz, dz));
+        StoreHits(hits, i, VLess(d2, VMul(r, r)));
+    }
+#endif
+    for (; i < count; i++) {
+        size_t a = single ? 0 : i;
+        float dx = ax[a] - bx[i], dy = ay[a] - by[i], dz = az[a] - bz[i];
+        float r = ar[a] + br[i];
+        if (dx * dx + dy * dy + dz * dz < r * r) {
+            hits[i >> 6] |= (uint64_t)1 << (i & 63);
+        }
+    }
+}
+
+static void SpherePlaneKernel(const float* x, const float* y, const float* z, const float* radius,
+                              glm::vec3 normal, float planeDistance, size_t count, uint64_t* hits) {
+    ClearHits(hits, count);
+    size_t i = 0;
+#if defined(CREATURE_SIMD_AVX2) || defined(CREATURE_SIMD_SSE2)
+    const vfloat nx = VSet(normal.x), ny = VSet(normal.y), nz = VSet(normal.z);
+    const vfloat offset = VSet(planeDistance);
+    const vfloat sign = VSet(-0.0f);
+    for (; i + LANES <= count; i += LANES) {
+        vfloat distance = VSub(VAdd(VAdd(VMul(nx, VLoad(x + i)), VMul(ny, VLoad(y + i))), VMul(nz, VLoad(z + i))), offset);
+        StoreHits(hits, i, VLessEqual(VAndNot(sign, distance), VLoad(radius + i)));
+    }
+#endif
+    for (; i < count; i++) {
+        float distance = normal.x * x[i] + normal.y * y[i] + normal.z * z[i] - planeDistance;
+        if (std::abs(distance) <= radius[i]) {
+            hits[i >> 6] |= (uint64_t)1 << (i & 63);
+        }
+    }
+}
+
+// Cilindro em pé: a esfera encosta se a distância até o segmento do eixo é
+// menor que a soma dos raios
+static void CylinderSphereKernel(glm::vec3 cylinderPosition, float cylinderRadius, float cylinderHeight,
+                                 const float* x, const float* y, const float* z, const float* radius,
+                                 size_t count, uint64_t* hits) {
+    ClearHits(hits, count);
+    float bottom = cylinderPosition.y - cylinderHeight * 0.5f;
+    float top = cylinderPosition.y + cylinderHeight * 0.5f;
+    size_t i = 0;
+#if defined(CREATURE_SIMD_AVX2) || defined(CREATURE_SIMD_SSE2)
+    const vfloat cx = VSet(cylinderPosition.x), cz = VSet(cylinderPosition.z);
+    const vfloat low = VSet(bottom), high = VSet(top);
+    const vfloat axis_radius = VSet(cylinderRadius);
+    for (; i + LANES <= count; i += LANES) {
+        vfloat py = VLoad(y + i);
+        vfloat dx = VSub(VLoad(x + i), cx);
+        vfloat dy = VSub(py, VMin(VMax(py, low), high));
+        vfloat dz = VSub(VLoad(z + i), cz);
+        vfloat r = VAdd(axis_radius, VLoad(radius + i));
+        vfloat d2 = VAdd(VAdd(VMul(dx, dx), VMul(dy, dy)), VMul(dz, dz));
+        StoreHits(hits, i, VLess(d2, VMul(r, r)));
+    }
+#endif
+    for (; i < count; i++) {
+        float dx = x[i] - cylinderPosition.x;
+        float dy = y[i] - glm::clamp(y[i], bottom, top);
+        float dz = z[i] - cylinderPosition.z;
+        float r = cylinderRadius + radius[i];
+        if (dx * dx + dy * dy + dz * dz < r * r) {
+            hits[i >> 6] |= (uint64_t)1 << (i & 63);
+        }
+    }
+}
+
 bool CheckSphereSphereOverlap(glm::vec3 posA, float radiusA, glm::vec3 posB, float radiusB) {
-    float distance = glm::length(posA - posB);
-    return distance < (radiusA + radiusB);
+    uint64_t hit;
+    SphereSphereKernel(&posA.x, &posA.y, &posA.z, &radiusA, true, &posB.x, &posB.y, &posB.z, &radiusB, 1, &hit);
+    return hit != 0;
 }
 
 bool SpherePlaneCollision(const glm::vec3 spherePosition, const float radius, const glm::vec3 normalPlane, const float planeDistance) {
-    glm::vec3 spherePosition3D = glm::vec3(spherePosition);
-    float distToPlane = glm::dot(normalPlane, spherePosition) - planeDistance;
-    return std::abs(distToPlane) <= radius;
+    uint64_t hit;
+    SpherePlaneKernel(&spherePosition.x, &spherePosition.y, &spherePosition.z, &radius, normalPlane, planeDistance, 1, &hit);
+    return hit != 0;
 }
 
 bool CylinderSphereCollision(glm::vec3 cylinderPosition, float cylinderRadius, float cylinderHeight, glm::vec3 spherePosition, float sphereRadius) {
-    // Calculate the closest point on the cylinder's axis to the sphere's center
-    float halfHeight = cylinderHeight * 0.5f;
-    glm::vec3 cylinderTop = cylinderPosition + glm::vec3(0, halfHeight, 0);
-    glm::vec3 cylinderBottom = cylinderPosition - glm::vec3(0, halfHeight, 0);
+    uint64_t hit;
+    CylinderSphereKernel(cylinderPosition, cylinderRadius, cylinderHeight,
+                         &spherePosition.x, &spherePosition.y, &spherePosition.z, &sphereRadius, 1, &hit);
+    return hit != 0;
+}
 
-    // Project the sphere's center onto the cylinder's axis
-    glm::vec3 axis = glm::normalize(cylinderTop - cylinderBottom);
-    float projection = glm::dot(spherePosition - cylinderBottom, axis);
-    projection = glm::clamp(projection, 0.0f, cylinderHeight);
+void SphereBatch::Clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+}
 
-    // Find the closest point on the cylinder's axis to the sphere
-    glm::vec3 closestPoint = cylinderBottom + axis * projection;
+void SphereBatch::Add(glm::vec3 center, float sphereRadius) {
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    radius.push_back(sphereRadius);
+}
 
-    // Check if the distance from the closest point to the sphere's center is less than the sum of the radii
-    float distance = glm::length(closestPoint - spherePosition);
-    return distance < (cylinderRadius + sphereRadius);
+size_t SphereBatch::Size() const {
+    return x.size();
 }
 
+void SphereSphereOverlapBatch(const SphereBatch& a, const SphereBatch& b, std::vector<uint64_t>& hits) {
+    hits.resize((b.Size() + 63) / 64);
+    SphereSphereKernel(a.x.data(), a.y.data(), a.z.data(), a.radius.data(), false,
+                       b.x.data(), b.y.data(), b.z.data(), b.radius.data(), b.Size(), hits.data());
+}
 
+void SphereSphereOverlapBatch(glm::vec3 center, float radius, const SphereBatch& spheres, std::vector<uint64_t>& hits) {
+    hits.resize((spheres.Size() + 63) / 64);
+    SphereSphereKernel(&center.x, &center.y, &center.z, &radius, true,
+                       spheres.x.data(), spheres.y.data(), spheres.z.data(), spheres.radius.data(), spheres.Size(), hits.data());
+}
+
+void SpherePlaneCollisionBatch(const SphereBatch& spheres, glm::vec3 normalPlane, float planeDistance, std::vector<uint64_t>& hits) {
+    hits.resize((spheres.Size() + 63) / 64);
+    SpherePlaneKernel(spheres.x.data(), spheres.y.data(), spheres.z.data(), spheres.radius.data(),
+                      normalPlane, planeDistance, spheres.Size(), hits.data());
+}
+
+void CylinderSphereCollisionBatch(glm::vec3 cylinderPosition, float cylinderRadius, float cylinderHeight, const SphereBatch& spheres, std::vector<uint64_t>& hits) {
+    hits.resize((spheres.Size() + 63) / 64);
+    CylinderSphereKernel(cylinderPosition, cylinderRadius, cylinderHeight,
+                         spheres.x.data(), spheres.y.data(), spheres.z.data(), spheres.radius.data(), spheres.Size(), hits.data());
+}
+
+void CollisionPairBuffer::Clear() {
+    pairs.clear();
+}
+
+void CollisionPairBuffer::Add(CollisionPairKind kind, uint32_t id) {
+    CollisionPair pair = {kind, id};
+    pairs.push_back(pair);
+}
+
+size_t CollisionPairBuffer::Size() const {
+    return pairs.size();
+}
+
+const CollisionPair* CollisionPairBuffer::begin() const {
+    return pairs.data();
+}
+
+const CollisionPair* CollisionPairBuffer::end() const {
+    return pairs.data() + pairs.size();
+}
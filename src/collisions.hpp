@@ -3,6 +3,8 @@
 
 #include <glm/gtc/type_ptr.hpp>
 #include <string>
+#include <vector>
+#include <stdint.h>
 
 struct AABB {
     glm::vec3 min;
@@ -15,4 +17,60 @@ bool CheckSphereSphereOverlap(glm::vec3 posA, float radiusA, glm::vec3 posB, flo
 bool SpherePlaneCollision(const glm::vec3 spherePosition, const float radius, const glm::vec3 normalPlane, const float planeDistance) ;
 bool CylinderSphereCollision(glm::vec3 cylinderPosition, float cylinderRadius, float cylinderHeight, glm::vec3 spherePosition, float sphereRadius);
 
+// Esferas em arrays separados (SoA), como os testes em lote leem
+struct SphereBatch {
+    std::vector<float> x, y, z, radius;
+
+    void Clear();
+    void Add(glm::vec3 center, float sphereRadius);
+    size_t Size() const;
+};
+
+// Testes em lote, em blocos SIMD (simd.hpp) e com distâncias ao quadrado,
+// sem sqrt. O resultado do teste k é o bit k % 64 de hits[k / 64]; "hits" é
+// redimensionado e zerado. As versões de um par acima chamam estas com um
+// lote de um.
+void SphereSphereOverlapBatch(const SphereBatch& a, const SphereBatch& b, std::vector<uint64_t>& hits); // a[k] com b[k]
+void SphereSphereOverlapBatch(glm::vec3 center, float radius, const SphereBatch& spheres, std::vector<uint64_t>& hits);
+void SpherePlaneCollisionBatch(const SphereBatch& spheres, glm::vec3 normalPlane, float planeDistance, std::vector<uint64_t>& hits);
+void CylinderSphereCollisionBatch(glm::vec3 cylinderPosition, float cylinderRadius, float cylinderHeight, const SphereBatch& spheres, std::vector<uint64_t>& hits);
+
+inline bool BatchHit(const std::vector<uint64_t>& hits, size_t k) {
+    return (hits[k >> 6] >> (k & 63)) & 1;
+}
+
+// O que a câmera encontrou na broad phase
+enum CollisionPairKind {
+    PAIR_CAMERA_SLIME, // id: CreatureHandle do slime
+    PAIR_CAMERA_WALL,  // id: CollisionWall
+    PAIR_CAMERA_STORE  // id: 0
+};
+
+// Paredes da skybox
+enum CollisionWall {
+    WALL_FRONT,
+    WALL_BACK,
+    WALL_LEFT,
+    WALL_RIGHT
+};
+
+struct CollisionPair {
+    CollisionPairKind kind;
+    uint32_t id;
+};
+
+// Pares de um tick para a narrow phase, que os percorre uma vez, em ordem.
+// Clear() no começo do tick esvazia o buffer mas mantém a memória.
+class CollisionPairBuffer {
+public:
+    void Clear();
+    void Add(CollisionPairKind kind, uint32_t id);
+    size_t Size() const;
+    const CollisionPair* begin() const;
+    const CollisionPair* end() const;
+
+private:
+    std::vector<CollisionPair> pairs;
+};
+
 #endif
\ No newline at end of file
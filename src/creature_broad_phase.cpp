@@ -0,0 +1,105 @@
+#include "creature_broad_phase.hpp"
+
+const SweepAndPrune::Proxy CreatureBroadPhase::NO_PROXY;
+
+// Câmera e loja começam sem tamanho, longe do mapa (e uma da outra), até
+// SetCamera() e SetStore()
+CreatureBroadPhase::CreatureBroadPhase() {
+    camera = sweep.Add(glm::vec3(1e9f), glm::vec3(1e9f), CREATURE_HANDLE_NONE);
+    store = sweep.Add(glm::vec3(-1e9f), glm::vec3(-1e9f), CREATURE_HANDLE_NONE);
+}
+
+void CreatureBroadPhase::SetCamera(const AABB& box) {
+    sweep.Move(camera, box.min, box.max);
+}
+
+void CreatureBroadPhase::SetStore(const AABB& box) {
+    sweep.Move(store, box.min, box.max);
+}
+
+// Cria ou move a caixa do slime; um proxy de outro handle no mesmo slot é
+// de um slime que já saiu
+void CreatureBroadPhase::Place(CreatureHandle handle, const CreaturePool& pool, size_t i) {
+    glm::vec3 half(CREATURE_BOX_SIZE * 0.5f);
+    glm::vec3 center(pool.position_x[i], pool.position_y[i], pool.position_z[i]);
+    uint32_t slot = SlotHandleIndex(handle);
+    if (slot >= slime_proxy.size()) {
+        slime_proxy.resize(slot + 1, NO_PROXY);
+    }
+    SweepAndPrune::Proxy proxy = slime_proxy[slot];
+    if (proxy != NO_PROXY && sweep.User(proxy) != handle) {
+        sweep.Remove(proxy);
+        proxy = NO_PROXY;
+    }
+    if (proxy == NO_PROXY) {
+        slime_proxy[slot] = sweep.Add(center - half, center + half, handle);
+    } else {
+        sweep.Move(proxy, center - half, center + half);
+    }
+}
+
+void CreatureBroadPhase::Drop(CreatureHandle handle) {
+    uint32_t slot = SlotHandleIndex(handle);
+    if (slot < slime_proxy.size() && slime_proxy[slot] != NO_PROXY && sweep.User(slime_proxy[slot]) == handle) {
+        sweep.Remove(slime_proxy[slot]);
+        slime_proxy[slot] = NO_PROXY;
+    }
+}
+
+void CreatureBroadPhase::Sync(CreatureWorld& world) {
+    if (!world.TracksChanges()) {
+        world.TrackChanges();
+        for (size_t chunk = 0; chunk < world.ChunkCount(); chunk++) {
+            const CreaturePool& pool = world.Chunk(chunk);
+            for (size_t i = 0; i < pool.Size(); i++) {
+                Place(pool.handle[i], pool, i);
+            }
+        }
+        sweep.Update();
+        return;
+    }
+    world.TakeChanges(changes);
+    // Saídas primeiro: o slot de um slime que saiu pode já ser de um que nasceu
+    for (size_t k = 0; k < changes.removed.size(); k++) {
+        Drop(changes.removed[k]);
+    }
+    for (int list = 0; list < 2; list++) {
+        const std::vector<CreatureHandle>& handles = list == 0 ? changes.added : changes.moved;
+        for (size_t k = 0; k < handles.size(); k++) {
+            CreatureKey key = world.Find(handles[k]);
+            // Quem saiu depois de nascer ou se mover já foi tirado acima
+            if (key != CREATURE_KEY_NONE) {
+                Place(handles[k], world.Chunk(CreatureKeyChunk(key)), CreatureKeyIndex(key));
+            }
+        }
+    }
+    sweep.Update();
+}
+
+void CreatureBroadPhase::GetPairs(BroadPhasePairs& out) {
+    out.camera_slimes.clear();
+    out.slime_slimes.clear();
+    out.store_slimes.clear();
+    out.camera_store = false;
+    scratch.clear();
+    sweep.GetPairs(scratch);
+    for (size_t k = 0; k < scratch.size(); k++) {
+        SweepAndPrune::Proxy a = scratch[k].first, b = scratch[k].second;
+        if (a == camera || a == store) {
+            // Câmera e loja são os dois primeiros proxies, então vêm sempre em "a"
+            if (b == store) {
+                out.camera_store = true;
+            } else if (a == camera) {
+                out.camera_slimes.push_back(sweep.User(b));
+            } else {
+                out.store_slimes.push_back(sweep.User(b));
+            }
+        } else {
+            out.slime_slimes.push_back(std::make_pair(sweep.User(a), sweep.User(b)));
+        }
+    }
+}
+
+size_t CreatureBroadPhase::Swaps() const {
+    return sweep.Swaps();
+}
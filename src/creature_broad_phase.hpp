@@ -0,0 +1,59 @@
+#ifndef CREATURE_BROAD_PHASE_HPP
+#define CREATURE_BROAD_PHASE_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include "collisions.hpp"
+#include "creature.hpp"
+#include "creature_world.hpp"
+#include "sweep_prune.hpp"
+
+// Lado da caixa de um slime na broad phase: dois slimes viram par quando
+// estão a menos de Creature::MIN_DISTANCE em X e em Z (ver CreatureSeparation)
+#define CREATURE_BOX_SIZE Creature::MIN_DISTANCE
+
+// Pares da broad phase, separados pelo que se encontra
+struct BroadPhasePairs {
+    std::vector<CreatureHandle> camera_slimes;
+    std::vector<std::pair<CreatureHandle, CreatureHandle> > slime_slimes;
+    std::vector<CreatureHandle> store_slimes;
+    bool camera_store;
+};
+
+// Caixas da câmera, da loja e de cada slime do mundo num SweepAndPrune que
+// dura a partida inteira. O primeiro Sync() põe todos os slimes e liga o
+// registro de mudanças do mundo; os seguintes só leem esse registro
+// (CreatureWorld::TakeChanges()), então um rancho parado quase não custa
+// nada. Os slimes são seguidos pelos CreatureHandles, então trocas de
+// índice e de chunk não contam como saída.
+class CreatureBroadPhase {
+public:
+    CreatureBroadPhase();
+
+    void SetCamera(const AABB& box);
+    void SetStore(const AABB& box);
+
+    void Sync(CreatureWorld& world);
+
+    // Pares depois do último Sync(); esvazia "out" antes
+    void GetPairs(BroadPhasePairs& out);
+
+    size_t Swaps() const;
+
+private:
+    static const SweepAndPrune::Proxy NO_PROXY = 0xFFFFFFFFu;
+
+    void Place(CreatureHandle handle, const CreaturePool& pool, size_t index);
+    void Drop(CreatureHandle handle);
+
+    SweepAndPrune sweep;
+    SweepAndPrune::Proxy camera;
+    SweepAndPrune::Proxy store;
+    std::vector<SweepAndPrune::Proxy> slime_proxy; // Por índice do handle (SlotHandleIndex)
+    CreatureChanges changes;
+    std::vector<SweepAndPrune::Pair> scratch;
+};
+
+#endif // CREATURE_BROAD_PHASE_HPP
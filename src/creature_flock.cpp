@@ -0,0 +1,130 @@
+#include "creature_flock.hpp"
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+#include "simd.hpp"
+
+CreatureFlock MakeCreatureFlock(bool enabled, float map_width, float map_length) {
+    CreatureFlock flock;
+    flock.enabled = enabled;
+    float tile_width = 2.0f * map_width / 3.0f;
+    float tile_length = 2.0f * map_length / 3.0f;
+    for (int type = 0; type < SLIME_TYPE_COUNT; type++) {
+        int tile = SLIME_TRAITS[type].tile;
+        flock.home[type] = glm::vec2(-map_width + tile_width * (tile % 3 + 0.5f), -map_length + tile_length * (tile / 3 + 0.5f));
+    }
+    flock.home_radius = 0.4f * std::min(tile_width, tile_length);
+    flock.vacuum = false;
+    flock.vacuum_position = glm::vec3(0.0f);
+    flock.flee_range = FLOCK_FLEE_RANGE;
+    return flock;
+}
+
+// Empurrão de cada par: na direção do vizinho para o slime, de 1 encostado a
+// 0 em MIN_DISTANCE. Os pares são completados com zeros até um bloco inteiro;
+// um par na mesma posição (d = 0) não empurra.
+static void PushPairs(FlockScratch& scratch) {
+    const float r = Creature::MIN_DISTANCE;
+    size_t count = scratch.dx.size();
+    size_t i = 0;
+#if defined(CREATURE_SIMD_AVX2) || defined(CREATURE_SIMD_SSE2)
+    size_t padded = (count + LANES - 1) / LANES * LANES;
+    scratch.dx.resize(padded, 0.0f);
+    scratch.dz.resize(padded, 0.0f);
+    scratch.push_x.resize(padded);
+    scratch.push_z.resize(padded);
+    const vfloat radius = VSet(r);
+    const vfloat inverse_radius = VSet(1.0f / r);
+    const vfloat zero = VSet(0.0f);
+    const vfloat tiny = VSet(1e-6f);
+    for (; i < padded; i += LANES) {
+        vfloat dx = VLoad(&scratch.dx[i]);
+        vfloat dz = VLoad(&scratch.dz[i]);
+        vfloat d = VSqrt(VAdd(VMul(dx, dx), VMul(dz, dz)));
+        vfloat weight = VDiv(VMul(VMax(VSub(radius, d), zero), inverse_radius), VMax(d, tiny));
+        weight = VAndNot(VLess(d, tiny), weight);
+        VStore(&scratch.push_x[i], VMul(dx, weight));
+        VStore(&scratch.push_z[i], VMul(dz, weight));
+    }
+    scratch.dx.resize(count);
+    scratch.dz.resize(count);
+#else
+    scratch.push_x.resize(count);
+    scratch.push_z.resize(count);
+#endif
+    for (; i < count; i++) {
+        float d = std::sqrt(scratch.dx[i] * scratch.dx[i] + scratch.dz[i] * scratch.dz[i]);
+        float weight = d < 1e-6f ? 0.0f : std::max(r - d, 0.0f) / r / d;
+        scratch.push_x[i] = scratch.dx[i] * weight;
+        scratch.push_z[i] = scratch.dz[i] * weight;
+    }
+}
+
+void SteerJumps(CreaturePool& pool, const std::vector<uint32_t>& started, const CreatureFlock& flock, FlockScratch& scratch) {
+    if (!flock.enabled || started.empty()) {
+        return;
+    }
+
+    // Todos os pares slime-vizinho dos pulos do tick, lado a lado
+    scratch.owner.clear();
+    scratch.dx.clear();
+    scratch.dz.clear();
+    for (size_t k = 0; k < started.size(); k++) {
+        uint32_t i = started[k];
+        float x = pool.position_x[i], z = pool.position_z[i];
+        scratch.neighbours.clear();
+        pool.grid.QueryRadius(x, z, Creature::MIN_DISTANCE, scratch.neighbours);
+        for (size_t n = 0; n < scratch.neighbours.size(); n++) {
+            uint32_t other = scratch.neighbours[n];
+            if (other != i) {
+                scratch.owner.push_back((uint32_t)k);
+                scratch.dx.push_back(x - pool.position_x[other]);
+                scratch.dz.push_back(z - pool.position_z[other]);
+            }
+        }
+    }
+    PushPairs(scratch);
+    scratch.separation_x.assign(started.size(), 0.0f);
+    scratch.separation_z.assign(started.size(), 0.0f);
+    for (size_t p = 0; p < scratch.owner.size(); p++) {
+        scratch.separation_x[scratch.owner[p]] += scratch.push_x[p];
+        scratch.separation_z[scratch.owner[p]] += scratch.push_z[p];
+    }
+
+    for (size_t k = 0; k < started.size(); k++) {
+        uint32_t i = started[k];
+        glm::vec2 position(pool.position_x[i], pool.position_z[i]);
+        glm::vec2 steer = FLOCK_WANDER_WEIGHT * glm::vec2(pool.direction_x[i], pool.direction_z[i]);
+        steer += FLOCK_SEPARATION_WEIGHT * glm::vec2(scratch.separation_x[k], scratch.separation_z[k]);
+
+        // Coesão: cresce com a distância além de home_radius, até 1
+        glm::vec2 to_home = flock.home[pool.type[i]] - position;
+        float home_distance = std::sqrt(to_home.x * to_home.x + to_home.y * to_home.y);
+        if (home_distance > flock.home_radius) {
+            float pull = std::min((home_distance - flock.home_radius) / flock.home_radius, 1.0f);
+            steer += FLOCK_COHESION_WEIGHT * pull / home_distance * to_home;
+        }
+
+        // Fuga: de 1 junto do aspirador a 0 em flee_range
+        if (flock.vacuum) {
+            glm::vec2 away = position - glm::vec2(flock.vacuum_position.x, flock.vacuum_position.z);
+            float distance = std::sqrt(away.x * away.x + away.y * away.y);
+            if (distance < flock.flee_range && distance > 1e-6f) {
+                steer += FLOCK_FLEE_WEIGHT * (1.0f - distance / flock.flee_range) / distance * away;
+            }
+        }
+
+        float length = std::sqrt(steer.x * steer.x + steer.y * steer.y);
+        if (length < 1e-6f) {
+            continue; // Forças se anulam: fica o rumo sorteado
+        }
+        // Mesma convenção de Jump(): direção (cos θ, -sin θ), θ em [0, 2π)
+        float angle = std::atan2(-steer.y, steer.x);
+        if (angle < 0.0f) {
+            angle += glm::two_pi<float>();
+        }
+        pool.target_rotation_angle[i] = angle;
+        pool.direction_x[i] = steer.x / length;
+        pool.direction_z[i] = steer.y / length;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef CREATURE_FLOCK_HPP
+#define CREATURE_FLOCK_HPP
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include "creature_pool.hpp"
+
+#define FLOCK_WANDER_WEIGHT 1.0f     // Rumo sorteado no pulo
+#define FLOCK_SEPARATION_WEIGHT 1.5f // Afastamento dos vizinhos a menos de MIN_DISTANCE
+#define FLOCK_COHESION_WEIGHT 0.75f  // Volta para o bioma do tipo
+#define FLOCK_FLEE_WEIGHT 3.0f       // Fuga do aspirador
+#define FLOCK_FLEE_RANGE 20.0f       // Metros; um pouco além do cone de captura
+
+// Comportamento de bando, aplicado só quando um slime começa a pular (fora do
+// pulo ele não anda). O rumo é a soma ponderada do rumo sorteado em Jump(),
+// da separação dos vizinhos, da coesão com o bioma do seu tipo e da fuga do
+// aspirador ligado.
+struct CreatureFlock {
+    bool enabled;
+    glm::vec2 home[SLIME_TYPE_COUNT]; // Centro do bioma de cada tipo
+    float home_radius;                // Dentro desse raio do centro não há coesão
+    bool vacuum;                      // Aspirador ligado em vacuum_position
+    glm::vec3 vacuum_position;
+    float flee_range;
+};
+
+// Bando com o centro dos biomas de um mapa [-map_width, map_width] x
+// [-map_length, map_length], aspirador desligado
+CreatureFlock MakeCreatureFlock(bool enabled, float map_width, float map_length);
+
+// Vetores de rascunho, reaproveitados entre ticks (um por thread)
+struct FlockScratch {
+    std::vector<uint32_t> neighbours;
+    std::vector<uint32_t> owner; // Por par: posição do slime em "started"
+    std::vector<float> dx, dz;   // Por par: do vizinho até o slime
+    std::vector<float> push_x, push_z;
+    std::vector<float> separation_x, separation_z; // Por slime de "started"
+};
+
+// Muda o rumo dos slimes em "started" que acabaram de pular. Os vizinhos vêm
+// da grade do pool (só os do mesmo chunk) e todos os pares slime-vizinho
+// dos pulos do tick são avaliados juntos, em blocos SIMD, então o custo
+// cresce com os pulos do tick e não com o quadrado da população.
+void SteerJumps(CreaturePool& pool, const std::vector<uint32_t>& started, const CreatureFlock& flock, FlockScratch& scratch);
+
+#endif // CREATURE_FLOCK_HPP
@@ -0,0 +1,382 @@
+#include "creature_pool.hpp"
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+#include <glm/trigonometric.hpp>
+#include "random.hpp"
+#include "terrain.hpp"
+
+CreaturePool::CreaturePool(uint64_t seed) : track_moves(false), seed(seed), tick(0), next_id(0), tick_step(0.0f), map_limit(MAP_LIMIT), terrain(NULL), grid(MAP_LIMIT + 1.0f) {
+}
+
+size_t CreaturePool::Size() const {
+    return type.size();
+}
+
+float CreaturePool::GroundHeight(float x, float z) const {
+    return terrain ? Creature::GROUND_LEVEL + terrain->Height(x, z) : Creature::GROUND_LEVEL;
+}
+
+//Operações aplicadas a todas as colunas do pool, de qualquer tipo
+struct ReserveColumn {
+    CreaturePool* pool;
+    size_t capacity;
+    template <typename T> void operator()(std::vector<T> CreaturePool::*column) const { (pool->*column).reserve(capacity); }
+};
+
+struct ClearColumn {
+    CreaturePool* pool;
+    template <typename T> void operator()(std::vector<T> CreaturePool::*column) const { (pool->*column).clear(); }
+};
+
+struct ShrinkColumn {
+    CreaturePool* pool;
+    template <typename T> void operator()(std::vector<T> CreaturePool::*column) const { (pool->*column).shrink_to_fit(); }
+};
+
+//Move o último elemento para a posição removida, sem deslocar o resto dos arrays
+struct SwapAndPopColumn {
+    CreaturePool* pool;
+    size_t index;
+    template <typename T> void operator()(std::vector<T> CreaturePool::*column) const {
+        std::vector<T>& values = pool->*column;
+        values[index] = values.back();
+        values.pop_back();
+    }
+};
+
+//Copia o elemento "index" de outro pool para o fim deste
+struct AppendColumn {
+    CreaturePool* pool;
+    const CreaturePool* source;
+    size_t index;
+    template <typename T> void operator()(std::vector<T> CreaturePool::*column) const { (pool->*column).push_back((source->*column)[index]); }
+};
+
+void CreaturePool::Reserve(size_t capacity) {
+    ReserveColumn reserve = {this, capacity};
+    VisitColumns(reserve);
+    grid.Reserve(capacity);
+    jumps.Reserve(capacity);
+}
+
+void CreaturePool::Clear() {
+    ClearColumn clear = {this};
+    VisitColumns(clear);
+    grid.Clear();
+    jumps.Clear();
+}
+
+void CreaturePool::ShrinkToFit() {
+    ShrinkColumn shrink = {this};
+    VisitColumns(shrink);
+    grid.ShrinkToFit();
+    jumps.ShrinkToFit();
+}
+
+size_t CreaturePool::Add(Slime_Type slime_type, float x, float y, float z) {
+    return Add(slime_type, x, y, z, next_id++);
+}
+
+size_t CreaturePool::Add(Slime_Type slime_type, float x, float y, float z, uint32_t creature_id) {
+    id.push_back(creature_id);
+    position_x.push_back(x);
+    position_y.push_back(y);
+    position_z.push_back(z);
+    vertical_velocity.push_back(0.0f);
+    direction_x.push_back(0.0f);
+    direction_z.push_back(0.0f);
+    rotation_angle.push_back(0.0f);
+    target_rotation_angle.push_back(0.0f);
+    capture_time.push_back(0.0f);
+    last_position_x.push_back(0.0f);
+    last_position_y.push_back(0.0f);
+    last_position_z.push_back(0.0f);
+    is_jumping.push_back(false);
+    captured.push_back(false);
+    type.push_back((unsigned char)slime_type);
+    awake.push_back(false);
+    previous_position_x.push_back(x);
+    previous_position_y.push_back(y);
+    previous_position_z.push_back(z);
+    previous_rotation_angle.push_back(0.0f);
+    sim_tick.push_back(tick);
+    handle.push_back(0);
+    grid.Insert(x, y, z);
+    jumps.Insert();
+    ScheduleJump(type.size() - 1, tick);
+    return type.size() - 1;
+}
+
+size_t CreaturePool::Remove(size_t index) {
+    size_t last = type.size() - 1;
+    SwapAndPopColumn swap_and_pop = {this, index};
+    VisitColumns(swap_and_pop);
+    grid.Remove((uint32_t)index);
+    jumps.Remove((uint32_t)index);
+    return index == last ? type.size() : last;
+}
+
+size_t CreaturePool::TakeFrom(CreaturePool& source, size_t index) {
+    AppendColumn append = {this, &source, index};
+    VisitColumns(append);
+    size_t taken = type.size() - 1;
+    grid.Insert(position_x[taken], position_y[taken], position_z[taken]);
+    jumps.Insert();
+    if (source.jumps.Scheduled((uint32_t)index)) {
+        jumps.Schedule((uint32_t)taken, source.jumps.Due((uint32_t)index));
+    }
+    source.Remove(index);
+    return taken;
+}
+
+//Pulo da criatura
+void CreaturePool::Jump(size_t i) {
+    if (!is_jumping[i]) {
+        Wake(i);
+        jumps.Cancel((uint32_t)i);
+        is_jumping[i] = true;
+        vertical_velocity[i] = SLIME_TRAITS[type[i]].params.jump_velocity;
+        target_rotation_angle[i] = CounterUniform(seed, id[i], tick, RNG_JUMP_ANGLE) * glm::two_pi<float>(); // Ângulo aleatório entre 0 e 2π
+        // Direção do movimento: (1, 0, 0) rotacionado em torno do eixo Y
+        direction_x[i] = cos(target_rotation_angle[i]);
+        direction_z[i] = -sin(target_rotation_angle[i]);
+    }
+}
+
+// log da chance de não pular em um tick, por tipo: o sorteio inteiro de 0 a
+// 99 pula quando fica abaixo de jump_chance
+struct JumpOdds {
+    float log_stay[SLIME_TYPE_COUNT];
+    JumpOdds() {
+        for (int type = 0; type < SLIME_TYPE_COUNT; type++) {
+            float chance = std::fmin(std::ceil(SLIME_TRAITS[type].params.jump_chance), 100.0f) / 100.0f;
+            log_stay[type] = chance < 1.0f ? std::log(1.0f - chance) : -INFINITY;
+        }
+    }
+};
+
+// Em vez de sortear a cada tick, sorteia quantos ticks seguidos falhariam:
+// pela inversa da distribuição geométrica, floor(log(1 - u) / log(1 - p))
+void CreaturePool::ScheduleJump(size_t i, uint32_t grounded_tick) {
+    static const JumpOdds odds;
+    float log_stay = odds.log_stay[type[i]];
+    float failures = 0.0f;
+    if (log_stay > -INFINITY) {
+        float roll = CounterUniform(seed, id[i], grounded_tick, RNG_JUMP_ROLL);
+        failures = std::floor(std::log(1.0f - roll) / log_stay);
+    }
+    jumps.Schedule((uint32_t)i, grounded_tick + 1 + (uint32_t)std::fmin(failures, 1e9f));
+}
+
+//Um slime dormindo não mudou, então o estado dele vale para o tick atual
+void CreaturePool::Wake(size_t i) {
+    if (!awake[i]) {
+        awake[i] = true;
+        sim_tick[i] = tick;
+    }
+}
+
+glm::vec4 CreaturePool::GetPosition(size_t i) const {
+    return glm::vec4(position_x[i], position_y[i], position_z[i], 1.0f);
+}
+
+void CreaturePool::SetPosition(size_t i, glm::vec4 position) {
+    position_x[i] = position.x;
+    position_y[i] = position.y;
+    position_z[i] = position.z;
+    grid.Move((uint32_t)i, position.x, position.y, position.z);
+    Wake(i);
+    MarkMoved(i);
+}
+
+void CreaturePool::MarkMoved(size_t i) {
+    if (track_moves) {
+        moved_handles.push_back(handle[i]);
+    }
+}
+
+void CreaturePool::SyncGrid() {
+    for (size_t i = 0; i < Size(); i++) {
+        grid.Move((uint32_t)i, position_x[i], position_y[i], position_z[i]);
+    }
+}
+
+void CreaturePool::SetMapLimit(float limit) {
+    map_limit = limit;
+    grid.Resize(limit + 1.0f, GRID_CELL_SIZE);
+}
+
+float CreaturePool::GetRotationAngle(size_t i) const {
+    return rotation_angle[i];
+}
+
+Slime_Type CreaturePool::GetType(size_t i) const {
+    return Slime_Type(type[i]);
+}
+
+//Posição que é desenhada: durante a captura o slime segue a curva guardada em last_position
+glm::vec4 CreaturePool::GetDrawnPosition(size_t i) const {
+    if (captured[i]) {
+        return glm::vec4(last_position_x[i], last_position_y[i], last_position_z[i], 1.0f);
+    }
+    return GetPosition(i);
+}
+
+// Slimes atrasados pelo LOD guardam o estado anterior quando são alcançados
+// (ver UpdateCreatureRangeLod()). Nos que dormem o anterior já é igual ao
+// atual, então copiar também não muda nada.
+void CreaturePool::SaveRenderState() {
+    for (size_t i = 0; i < Size(); i++) {
+        if (sim_tick[i] != tick) {
+            continue;
+        }
+        glm::vec4 position = GetDrawnPosition(i);
+        previous_position_x[i] = position.x;
+        previous_position_y[i] = position.y;
+        previous_position_z[i] = position.z;
+        previous_rotation_angle[i] = rotation_angle[i];
+    }
+}
+
+glm::vec4 CreaturePool::GetRenderPosition(size_t i, float alpha) const {
+    if (awake[i] && sim_tick[i] < tick) {
+        CreatureMotion motion = Predict(i, float(tick - sim_tick[i]) - 1.0f + alpha, tick_step);
+        return glm::vec4(motion.x, motion.y, motion.z, 1.0f);
+    }
+    glm::vec4 previous(previous_position_x[i], previous_position_y[i], previous_position_z[i], 1.0f);
+    return previous + (GetDrawnPosition(i) - previous) * alpha;
+}
+
+float CreaturePool::GetRenderRotation(size_t i, float alpha) const {
+    if (awake[i] && sim_tick[i] < tick) {
+        return Predict(i, float(tick - sim_tick[i]) - 1.0f + alpha, tick_step).rotation_angle;
+    }
+    // Interpola pelo menor arco, já que a rotação pode saltar 2π ao alcançar o alvo
+    float diff = rotation_angle[i] - previous_rotation_angle[i];
+    diff -= glm::two_pi<float>() * std::floor(diff / glm::two_pi<float>() + 0.5f);
+    return previous_rotation_angle[i] + diff * alpha;
+}
+
+// Primeiro passo k >= 1 em que o integrador (v += g·dt; y += v·dt) fica abaixo
+// de "height": y_k = y + dt·(k·v + g·dt·k(k+1)/2), uma parábola em k
+static float LandingStep(float y, float v, float gravity, float delta_t, float height) {
+    if (gravity >= 0.0f || delta_t <= 0.0f) {
+        return INFINITY;
+    }
+    float a = 0.5f * gravity * delta_t * delta_t;
+    float b = v * delta_t + a;
+    float c = y - height;
+    float discriminant = std::fmax(b * b - 4.0f * a * c, 0.0f);
+    float k = std::fmax(1.0f, std::floor((-b - std::sqrt(discriminant)) / (2.0f * a)) + 1.0f);
+    // Corrige o arredondamento da raiz, que erra no máximo um passo
+    if (k > 1.0f && (a * (k - 1.0f) + b) * (k - 1.0f) + c < 0.0f) {
+        return k - 1.0f;
+    }
+    if ((a * k + b) * k + c >= 0.0f) {
+        return k + 1.0f;
+    }
+    return k;
+}
+
+// Rotação depois de "steps" passos de RotationStep(): anda no sentido de
+// (target - rotation) até a distância caber em um passo
+static float RotationAfter(float rotation, float target, float rotation_speed, float steps) {
+    float diff = target - rotation;
+    float dist = std::fabs(diff);
+    float circular = std::fmin(dist, glm::two_pi<float>() - dist);
+    if (circular <= rotation_speed || dist <= rotation_speed * steps) {
+        return target;
+    }
+    return rotation + std::copysign(rotation_speed * steps, diff);
+}
+
+//Estado do slime "steps" passos à frente, dado o passo do pouso e a altura do chão
+static inline CreatureMotion MotionAfter(const CreaturePool& pool, size_t i, float steps, float landing, float ground, float delta_t) {
+    CreatureMotion motion = {pool.position_x[i], pool.position_y[i], pool.position_z[i], pool.vertical_velocity[i], pool.rotation_angle[i], pool.is_jumping[i] != 0, 0.0f};
+    if (steps <= 0.0f) {
+        return motion;
+    }
+    if (steps >= landing) {
+        motion.y = ground;
+        motion.vertical_velocity = 0.0f;
+        motion.is_jumping = false;
+        motion.grounded_steps = steps - landing + 1.0f;
+    } else {
+        float gravity = SLIME_TRAITS[pool.type[i]].params.gravity;
+        motion.y = std::fmax(ground, pool.position_y[i] + delta_t * (steps * pool.vertical_velocity[i] + gravity * delta_t * steps * (steps + 1.0f) * 0.5f));
+        motion.vertical_velocity = pool.vertical_velocity[i] + gravity * delta_t * steps;
+    }
+    if (pool.is_jumping[i]) {
+        // O passo do pouso já não anda; em linha reta, limitar no fim equivale a limitar a cada passo
+        float moving = std::fmin(steps, landing - 1.0f) * delta_t;
+        motion.x = std::fmin(std::fmax(pool.position_x[i] + pool.direction_x[i] * moving, -pool.map_limit), pool.map_limit);
+        motion.z = std::fmin(std::fmax(pool.position_z[i] + pool.direction_z[i] * moving, -pool.map_limit), pool.map_limit);
+    }
+    float rotation_speed = glm::radians(CREATURE_ROTATION_SPEED) * delta_t;
+    motion.rotation_angle = RotationAfter(pool.rotation_angle[i], pool.target_rotation_angle[i], rotation_speed, steps);
+    return motion;
+}
+
+//Dobra "x" para dentro de [-limit, limit], como um slime que volta ao bater na borda
+static float Reflect(float x, float limit) {
+    float period = 4.0f * limit;
+    float t = std::fmod(x + limit, period);
+    if (t < 0.0f) {
+        t += period;
+    }
+    return t <= 2.0f * limit ? t - limit : 3.0f * limit - t;
+}
+
+void CreaturePool::CatchUp(float seconds, float delta_t) {
+    static const JumpOdds odds;
+    if (seconds <= 0.0f || delta_t <= 0.0f) {
+        return;
+    }
+    // Desvio do passeio de cada tipo: um pulo anda 1 m/s durante o voo (2v/|g|)
+    // e um slime espera em média 1/p ticks no chão antes de pular
+    float sigma[SLIME_TYPE_COUNT];
+    for (int t = 0; t < SLIME_TYPE_COUNT; t++) {
+        const SlimeParams& params = SLIME_TRAITS[t].params;
+        float flight = 2.0f * params.jump_velocity / -params.gravity;
+        float chance = 1.0f - std::exp(odds.log_stay[t]);
+        float jumps = seconds / (flight + delta_t / chance);
+        sigma[t] = flight * std::sqrt(0.5f * jumps);
+    }
+    for (size_t i = 0; i < Size(); i++) {
+        if (captured[i]) {
+            continue;
+        }
+        float radius = std::sqrt(-2.0f * std::log(1.0f - CounterUniform(seed, id[i], tick, RNG_CATCH_UP_RADIUS)));
+        float angle = CounterUniform(seed, id[i], tick, RNG_CATCH_UP_ANGLE) * glm::two_pi<float>();
+        float x = Reflect(position_x[i] + sigma[type[i]] * radius * std::cos(angle), map_limit);
+        float z = Reflect(position_z[i] + sigma[type[i]] * radius * std::sin(angle), map_limit);
+        float facing = CounterUniform(seed, id[i], tick, RNG_CATCH_UP_FACING) * glm::two_pi<float>();
+        position_x[i] = previous_position_x[i] = x;
+        position_y[i] = previous_position_y[i] = GroundHeight(x, z);
+        position_z[i] = previous_position_z[i] = z;
+        rotation_angle[i] = target_rotation_angle[i] = previous_rotation_angle[i] = facing;
+        vertical_velocity[i] = 0.0f;
+        is_jumping[i] = false;
+        awake[i] = false;
+        sim_tick[i] = tick;
+        grid.Move((uint32_t)i, x, position_y[i], z);
+        MarkMoved(i);
+        jumps.Cancel((uint32_t)i);
+        ScheduleJump(i, tick);
+    }
+}
+
+CreatureMotion CreaturePool::Predict(size_t i, float steps, float delta_t, CreatureMotion* step_before) const {
+    float landing = 1.0f; // Parado no chão: o primeiro passo já "pousa"
+    float ground = GroundHeight(position_x[i], position_z[i]);
+    if (captured[i]) {
+        landing = INFINITY;
+        steps = 0.0f;
+    } else if (is_jumping[i] || position_y[i] != ground || vertical_velocity[i] != 0.0f) {
+        landing = LandingStep(position_y[i], vertical_velocity[i], SLIME_TRAITS[type[i]].params.gravity, delta_t, ground);
+    }
+    if (step_before) {
+        *step_before = MotionAfter(*this, i, steps - 1.0f, landing, ground, delta_t);
+    }
+    return MotionAfter(*this, i, steps, landing, ground, delta_t);
+}
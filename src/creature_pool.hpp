@@ -0,0 +1,160 @@
+#ifndef CREATURE_POOL_HPP
+#define CREATURE_POOL_HPP
+
+#include <glm/vec4.hpp>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+#include "slime_types.hpp"
+#include "spatial_grid.hpp"
+#include "timing_wheel.hpp"
+
+class Terrain;
+
+#define MAP_LIMIT 299.0f // Limite padrão de x e z dos slimes no mapa de 300
+#define CREATURE_ROTATION_SPEED 90.0f // Graus por segundo ao virar para o ângulo alvo
+
+// Estado de um slime avançado alguns passos sem novos pulos (ver Predict())
+struct CreatureMotion {
+    float x, y, z;
+    float vertical_velocity;
+    float rotation_angle;
+    bool is_jumping;
+    float grounded_steps; // Passos passados no chão, em que um pulo poderia ter sido sorteado
+};
+
+// Armazena todos os slimes em arrays paralelos (structure of arrays), um
+// elemento por criatura. Os parâmetros de cada tipo ficam em SLIME_TRAITS,
+// então o laço de atualização percorre a memória de forma contígua.
+class CreaturePool {
+public:
+    CreaturePool(uint64_t seed = 0);
+
+    size_t Size() const;
+    void Reserve(size_t capacity);
+    void Clear();
+    void ShrinkToFit(); //Devolve a memória que sobra das colunas, da grade e da agenda
+
+    size_t Add(Slime_Type type, float x, float y, float z); //Retorna o índice da nova criatura
+    size_t Add(Slime_Type type, float x, float y, float z, uint32_t id); //Com id dado por quem reparte os ids entre pools
+    size_t Remove(size_t index); //Swap-and-pop; retorna o índice antigo do elemento movido para "index" (Size() se nenhum)
+    // Passa o slime "index" de "source" para este pool com todo o estado,
+    // inclusive o pulo agendado (as agendas precisam estar no mesmo tick), e o
+    // remove de "source" como Remove(). Retorna o índice novo.
+    size_t TakeFrom(CreaturePool& source, size_t index);
+
+    void Jump(size_t index); //Também acorda o slime e tira o pulo da agenda
+
+    // Pulos agendados: um slime no chão tem o tick do próximo pulo em "jumps",
+    // sorteado de uma vez pela distribuição geométrica equivalente ao sorteio
+    // de jump_chance a cada tick. Slimes acordados (awake) estão no ar,
+    // girando ou capturados; os outros não mudam e não são atualizados.
+    void ScheduleJump(size_t index, uint32_t grounded_tick); //Sorteia o próximo pulo de quem está no chão desde grounded_tick
+    void Wake(size_t index);
+
+    glm::vec4 GetPosition(size_t index) const;
+    void SetPosition(size_t index, glm::vec4 position); //Também move o slime na grade e o acorda
+    float GetRotationAngle(size_t index) const;
+    Slime_Type GetType(size_t index) const;
+    glm::vec4 GetDrawnPosition(size_t index) const;
+
+    // Estado do tick anterior, para interpolar o desenho entre dois ticks da simulação
+    void SaveRenderState(); //Chamado no início de cada tick
+    glm::vec4 GetRenderPosition(size_t index, float alpha) const;
+    float GetRenderRotation(size_t index, float alpha) const;
+
+    // Avança o slime "steps" passos de delta_t em forma fechada: o arco do
+    // pulo, o pouso, o movimento e a rotação saem iguais aos da atualização
+    // passo a passo, só sem sortear pulos novos. "steps" pode ser fracionário.
+    // O chão do pouso é o do ponto atual; se o pulo termina em outra altura,
+    // o próximo passo normal acerta (sobe até o chão ou cai até ele).
+    // Se "step_before" não for nulo, recebe também o estado um passo antes.
+    CreatureMotion Predict(size_t index, float steps, float delta_t, CreatureMotion* step_before = NULL) const;
+
+    // Avança "seconds" segundos de uma vez, sem passos: cada slime solto faz
+    // em média seconds / (voo + espera) pulos de direção sorteada, um passeio
+    // aleatório, então a posição final sai de uma normal com essa variância,
+    // refletida nos limites do mapa. Todos terminam parados no chão, com o
+    // próximo pulo sorteado de novo. Não conhece o bando (CreatureFlock) e não
+    // muda o tick. Quem sai do bioma fica para a troca de chunk do mundo.
+    void CatchUp(float seconds, float delta_t);
+
+    std::vector<uint32_t> id; // Identificador único e estável, usado como chave do gerador aleatório
+    std::vector<float> position_x;
+    std::vector<float> position_y;
+    std::vector<float> position_z;
+    std::vector<float> vertical_velocity;
+    std::vector<float> direction_x; // Direção do movimento (plano XZ)
+    std::vector<float> direction_z;
+    std::vector<float> rotation_angle; // Ângulo de rotação atual em radianos
+    std::vector<float> target_rotation_angle; // Ângulo de rotação alvo em radianos
+    std::vector<float> capture_time;
+    std::vector<float> last_position_x; // Última posição durante a captura
+    std::vector<float> last_position_y;
+    std::vector<float> last_position_z;
+    std::vector<unsigned char> is_jumping;
+    std::vector<unsigned char> captured;
+    std::vector<unsigned char> type;
+    std::vector<unsigned char> awake;
+    std::vector<float> previous_position_x;
+    std::vector<float> previous_position_y;
+    std::vector<float> previous_position_z;
+    std::vector<float> previous_rotation_angle;
+    std::vector<uint32_t> sim_tick; // Ticks já simulados; fica para trás nos slimes distantes (ver CreatureLod)
+    std::vector<uint32_t> handle; // Handle do slime no CreatureWorld (0 em um pool fora de um mundo)
+
+    // Com track_moves, os handles dos slimes que mudaram de lugar (num tick,
+    // em SetPosition() ou em CatchUp()) vão para moved_handles, até
+    // CreatureWorld::TakeChanges() recolhê-los
+    bool track_moves;
+    std::vector<uint32_t> moved_handles;
+    void MarkMoved(size_t index);
+
+    uint64_t seed; // Seed do rancho (ver random.hpp)
+    uint32_t tick; // Quadro atual da simulação, incrementado por UpdateCreaturesSerial()
+    uint32_t next_id;
+    float tick_step; // delta_t da última atualização, usado para prever slimes atrasados
+    float map_limit; // Slimes ficam em [-map_limit, map_limit] nos eixos x e z
+    const Terrain* terrain; // Relevo do chão; NULL deixa o chão plano em GROUND_LEVEL
+    float GroundHeight(float x, float z) const; // Altura do chão de um slime em (x, z)
+
+    // Grade com a posição de cada slime, pelo mesmo índice do pool. Add(),
+    // Remove() e SetPosition() a mantêm em dia; quem escreve em position_*
+    // diretamente chama SyncGrid() depois.
+    SpatialGrid grid;
+    void SyncGrid();
+    void SetMapLimit(float limit); //Também redimensiona a grade
+
+    TimingWheel jumps; // Próximo pulo de cada slime, pelo mesmo índice do pool
+
+private:
+    //Aplica "visitor" ao ponteiro de membro de cada coluna; toda coluna nova precisa ser listada aqui
+    template <typename Visitor>
+    static void VisitColumns(Visitor& visitor) {
+        visitor(&CreaturePool::id);
+        visitor(&CreaturePool::position_x);
+        visitor(&CreaturePool::position_y);
+        visitor(&CreaturePool::position_z);
+        visitor(&CreaturePool::vertical_velocity);
+        visitor(&CreaturePool::direction_x);
+        visitor(&CreaturePool::direction_z);
+        visitor(&CreaturePool::rotation_angle);
+        visitor(&CreaturePool::target_rotation_angle);
+        visitor(&CreaturePool::capture_time);
+        visitor(&CreaturePool::last_position_x);
+        visitor(&CreaturePool::last_position_y);
+        visitor(&CreaturePool::last_position_z);
+        visitor(&CreaturePool::is_jumping);
+        visitor(&CreaturePool::captured);
+        visitor(&CreaturePool::type);
+        visitor(&CreaturePool::awake);
+        visitor(&CreaturePool::previous_position_x);
+        visitor(&CreaturePool::previous_position_y);
+        visitor(&CreaturePool::previous_position_z);
+        visitor(&CreaturePool::previous_rotation_angle);
+        visitor(&CreaturePool::sim_tick);
+        visitor(&CreaturePool::handle);
+    }
+};
+
+#endif // CREATURE_POOL_HPP
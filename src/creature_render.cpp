@@ -0,0 +1,105 @@
+#include "creature_render.hpp"
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+
+//Rotate_X(3π/2) * Scale(s), o mesmo que Matrix_Rotate_X e Matrix_Scale em matrices.h
+static glm::mat4 MeshBaseMatrix(const SlimeMesh& mesh) {
+    glm::mat4 base(mesh.scale);
+    base[3][3] = 1.0f;
+    if (mesh.rotate_x) {
+        float angle = 3 * 3.141592f / 2.0f;
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+        glm::mat4 rotation(1.0f);
+        rotation[1][1] = c;
+        rotation[1][2] = s;
+        rotation[2][1] = -s;
+        rotation[2][2] = c;
+        base = rotation * base;
+    }
+    return base;
+}
+
+//Rotate_Y(angle); a translação entra direto na quarta coluna
+static glm::mat4 RotateY(float angle) {
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    return glm::mat4(
+         c,   0.0f, -s,   0.0f,  // Coluna 1
+        0.0f, 1.0f, 0.0f, 0.0f,  // Coluna 2
+         s,   0.0f,  c,   0.0f,  // Coluna 3
+        0.0f, 0.0f, 0.0f, 1.0f   // Coluna 4
+    );
+}
+
+void CaptureCreatures(JobSystem& jobs, const CreatureWorld& world, CreatureSnapshot& out) {
+    // Os slimes dos chunks são numerados em sequência: o chunk c começa em first[c]
+    size_t first[WORLD_CHUNK_COUNT + 1] = {0};
+    for (size_t c = 0; c < WORLD_CHUNK_COUNT; c++) {
+        first[c + 1] = first[c] + world.Chunk(c).Size();
+    }
+    size_t count = first[WORLD_CHUNK_COUNT];
+    out.from.resize(count);
+    out.to.resize(count);
+    out.from_rotation.resize(count);
+    out.to_rotation.resize(count);
+    out.ground.resize(count);
+    out.type.resize(count);
+
+    jobs.ParallelFor(count, CREATURE_RENDER_GRAIN, [&](size_t begin, size_t end) {
+        size_t c = 0;
+        for (size_t k = begin; k < end; k++) {
+            while (first[c + 1] <= k) {
+                c++;
+            }
+            const CreaturePool& pool = world.Chunk(c);
+            size_t i = k - first[c];
+            // Os slimes do LOD seguem Predict(), uma curva; dentro de um tick a reta basta
+            glm::vec4 from = pool.GetRenderPosition(i, 0.0f);
+            glm::vec4 to = pool.GetRenderPosition(i, 1.0f);
+            float from_rotation = pool.GetRenderRotation(i, 0.0f);
+            float turn = pool.GetRenderRotation(i, 1.0f) - from_rotation;
+            turn -= glm::two_pi<float>() * std::floor(turn / glm::two_pi<float>() + 0.5f);
+            out.from[k] = glm::vec3(from);
+            out.to[k] = glm::vec3(to);
+            out.from_rotation[k] = from_rotation;
+            out.to_rotation[k] = from_rotation + turn;
+            out.ground[k] = pool.GroundHeight(to.x, to.z);
+            out.type[k] = pool.type[i];
+        }
+    });
+}
+
+void BuildCreatureInstances(JobSystem& jobs, const CreatureSnapshot& creatures, float alpha, const glm::mat4& shadow_matrix, bool shadows, CreatureInstances& out) {
+    size_t count = creatures.type.size();
+
+    // Reserva a posição de cada slime no grupo do seu tipo, na ordem do snapshot
+    size_t type_count[SLIME_TYPE_COUNT] = {0};
+    out.slot.resize(count);
+    for (size_t k = 0; k < count; k++) {
+        out.slot[k] = (uint32_t)type_count[creatures.type[k]]++;
+    }
+    glm::mat4 base[SLIME_TYPE_COUNT];
+    for (int t = 0; t < SLIME_TYPE_COUNT; t++) {
+        out.models[t].resize(type_count[t]);
+        out.shadows[t].resize(shadows ? type_count[t] : 0);
+        base[t] = MeshBaseMatrix(SLIME_TRAITS[t].mesh);
+    }
+
+    jobs.ParallelFor(count, CREATURE_RENDER_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            int t = creatures.type[k];
+            glm::vec3 position = creatures.from[k] + (creatures.to[k] - creatures.from[k]) * alpha;
+            float rotation_angle = creatures.from_rotation[k] + (creatures.to_rotation[k] - creatures.from_rotation[k]) * alpha;
+            glm::mat4 rotated = RotateY(rotation_angle) * base[t];
+            glm::mat4 model = rotated;
+            model[3] = glm::vec4(position.x, position.y - 1.5f, position.z, 1.0f);
+            out.models[t][out.slot[k]] = model;
+            if (shadows) {
+                glm::mat4 shadow = shadow_matrix * rotated;
+                shadow[3] += glm::vec4(position.x, creatures.ground[k] - 1.0f, position.z, 0.0f);
+                out.shadows[t][out.slot[k]] = shadow;
+            }
+        }
+    });
+}
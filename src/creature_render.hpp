@@ -0,0 +1,44 @@
+#ifndef CREATURE_RENDER_HPP
+#define CREATURE_RENDER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include "creature_world.hpp"
+#include "job_system.hpp"
+#include "slime_types.hpp"
+
+#define CREATURE_RENDER_GRAIN 2048 // Slimes por tarefa ao montar as matrizes
+
+// Slimes de um tick copiados do mundo para o desenho, que pode ler a cópia
+// enquanto a simulação já avança o tick seguinte (ver SimulationThread). Para
+// cada slime, em ordem dos chunks: a posição e a rotação no começo (alpha 0)
+// e no fim (alpha 1) do intervalo que o desenho interpola e a altura do chão
+// para a sombra. Os vetores são reaproveitados entre ticks.
+struct CreatureSnapshot {
+    std::vector<glm::vec3> from;
+    std::vector<glm::vec3> to;
+    std::vector<float> from_rotation;
+    std::vector<float> to_rotation; // Pelo menor arco a partir de from_rotation
+    std::vector<float> ground;
+    std::vector<unsigned char> type;
+};
+
+// Matrizes de modelo (e da sombra) de todos os slimes, agrupadas por tipo
+// para serem desenhadas com uma chamada instanciada por parte do modelo.
+// Os vetores são reaproveitados entre quadros.
+struct CreatureInstances {
+    std::vector<glm::mat4> models[SLIME_TYPE_COUNT];
+    std::vector<glm::mat4> shadows[SLIME_TYPE_COUNT];
+    std::vector<uint32_t> slot; // Posição de cada slime dentro do grupo do seu tipo
+};
+
+// Copia os slimes do mundo, dividindo o trabalho entre as threads do JobSystem
+void CaptureCreatures(JobSystem& jobs, const CreatureWorld& world, CreatureSnapshot& out);
+
+// Monta as matrizes interpolando entre os dois lados do snapshot (alpha), dividindo
+// o trabalho entre as threads do JobSystem. Sombras só se "shadows" for true.
+void BuildCreatureInstances(JobSystem& jobs, const CreatureSnapshot& creatures, float alpha, const glm::mat4& shadow_matrix, bool shadows, CreatureInstances& out);
+
+#endif // CREATURE_RENDER_HPP
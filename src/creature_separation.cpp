@@ -0,0 +1,157 @@
+#include "creature_separation.hpp"
+#include <algorithm>
+#include <cmath>
+
+const uint32_t CreatureSeparation::NO_BODY;
+
+CreatureSeparation::CreatureSeparation() : cursor(0), stamp(0) {
+}
+
+// Índice local do slime, criado na primeira vez que ele aparece no tick
+uint32_t CreatureSeparation::Body(const CreatureWorld& world, CreatureHandle handle) {
+    uint32_t slot = SlotHandleIndex(handle);
+    if (slot >= body_slot.size()) {
+        body_slot.resize(slot + 1, NO_BODY);
+        body_stamp.resize(slot + 1, 0);
+    }
+    if (body_stamp[slot] == stamp) {
+        return body_slot[slot];
+    }
+    CreatureKey found = world.Find(handle);
+    if (found == CREATURE_KEY_NONE) {
+        return NO_BODY;
+    }
+    const CreaturePool& pool = world.Chunk(CreatureKeyChunk(found));
+    size_t i = CreatureKeyIndex(found);
+    uint32_t body = (uint32_t)key.size();
+    key.push_back(found);
+    x.push_back(pool.position_x[i]);
+    z.push_back(pool.position_z[i]);
+    weight.push_back(pool.captured[i] ? 0.0f : 1.0f);
+    colors_used.push_back(0);
+    body_slot[slot] = body;
+    body_stamp[slot] = stamp;
+    return body;
+}
+
+// Coloração gulosa: cada par fica com a menor cor livre nos dois slimes
+void CreatureSeparation::Color() {
+    size_t count = pair_a.size();
+    size_t per_color[SEPARATION_COLORS] = {0};
+    pair_color.resize(count);
+    for (size_t k = 0; k < count; k++) {
+        uint64_t used = colors_used[pair_a[k]] | colors_used[pair_b[k]];
+        uint32_t color = 0;
+        while (color < SEPARATION_COLORS - 1 && (used >> color & 1)) {
+            color++;
+        }
+        colors_used[pair_a[k]] |= (uint64_t)1 << color;
+        colors_used[pair_b[k]] |= (uint64_t)1 << color;
+        pair_color[k] = color;
+        per_color[color]++;
+    }
+    color_start[0] = 0;
+    for (int c = 0; c < SEPARATION_COLORS; c++) {
+        color_start[c + 1] = color_start[c] + per_color[c];
+    }
+    ordered_a.resize(count);
+    ordered_b.resize(count);
+    size_t next[SEPARATION_COLORS];
+    std::copy(color_start, color_start + SEPARATION_COLORS, next);
+    for (size_t k = 0; k < count; k++) {
+        size_t slot = next[pair_color[k]]++;
+        ordered_a[slot] = pair_a[k];
+        ordered_b[slot] = pair_b[k];
+    }
+}
+
+void CreatureSeparation::Relax(size_t begin, size_t end) {
+    const float contact = SEPARATION_DISTANCE;
+    const float tolerated = contact - SEPARATION_SLOP;
+    for (size_t k = begin; k < end; k++) {
+        uint32_t a = ordered_a[k], b = ordered_b[k];
+        float dx = x[b] - x[a];
+        float dz = z[b] - z[a];
+        float d2 = dx * dx + dz * dz;
+        if (d2 >= tolerated * tolerated) {
+            continue;
+        }
+        float d = std::sqrt(d2);
+        if (d < 1e-6f) {
+            // Mesmo lugar: um rumo fixo por par, para slimes empilhados se abrirem em leque
+            float angle = (float)k * 2.39996323f;
+            dx = std::cos(angle);
+            dz = std::sin(angle);
+            d = 1.0f;
+        }
+        float correction = (contact - std::min(d, contact)) / ((weight[a] + weight[b]) * d);
+        x[a] -= dx * correction * weight[a];
+        z[a] -= dz * correction * weight[a];
+        x[b] += dx * correction * weight[b];
+        z[b] += dz * correction * weight[b];
+    }
+}
+
+size_t CreatureSeparation::Solve(JobSystem& jobs, CreatureWorld& world, const std::vector<HandlePair>& pairs) {
+    const float tolerated = SEPARATION_DISTANCE - SEPARATION_SLOP;
+    stamp++;
+    key.clear();
+    x.clear();
+    z.clear();
+    weight.clear();
+    colors_used.clear();
+    pair_a.clear();
+    pair_b.clear();
+    size_t count = std::min(pairs.size(), (size_t)SEPARATION_MAX_PAIRS);
+    size_t first = pairs.size() > count ? cursor % pairs.size() : 0;
+    cursor = first + count;
+    size_t overlapping = 0;
+    for (size_t k = 0; k < count; k++) {
+        const HandlePair& pair = pairs[(first + k) % pairs.size()];
+        uint32_t a = Body(world, pair.first);
+        uint32_t b = Body(world, pair.second);
+        if (a == NO_BODY || b == NO_BODY || weight[a] + weight[b] == 0.0f) {
+            continue;
+        }
+        float dx = x[b] - x[a], dz = z[b] - z[a];
+        if (dx * dx + dz * dz < tolerated * tolerated) {
+            pair_a.push_back(a);
+            pair_b.push_back(b);
+            overlapping++;
+        }
+    }
+    if (pair_a.empty()) {
+        return 0;
+    }
+    Color();
+
+    for (int iteration = 0; iteration < SEPARATION_ITERATIONS; iteration++) {
+        for (int c = 0; c < SEPARATION_COLORS; c++) {
+            size_t begin = color_start[c], end = color_start[c + 1];
+            // A última cor pode repetir slimes e roda sempre numa thread só
+            if (c < SEPARATION_COLORS - 1 && end - begin >= SEPARATION_PARALLEL_MIN_PAIRS && jobs.WorkerCount() > 0) {
+                jobs.ParallelFor(end - begin, SEPARATION_PARALLEL_MIN_PAIRS / 4, [&](size_t from, size_t to) {
+                    Relax(begin + from, begin + to);
+                });
+            } else {
+                Relax(begin, end);
+            }
+        }
+    }
+
+    for (size_t body = 0; body < key.size(); body++) {
+        if (weight[body] == 0.0f) {
+            continue;
+        }
+        CreaturePool& pool = world.Chunk(CreatureKeyChunk(key[body]));
+        size_t i = CreatureKeyIndex(key[body]);
+        float new_x = std::fmin(std::fmax(x[body], -pool.map_limit), pool.map_limit);
+        float new_z = std::fmin(std::fmax(z[body], -pool.map_limit), pool.map_limit);
+        if (new_x == pool.position_x[i] && new_z == pool.position_z[i]) {
+            continue;
+        }
+        float height = pool.is_jumping[i] ? pool.position_y[i] : pool.GroundHeight(new_x, new_z);
+        pool.SetPosition(i, glm::vec4(new_x, height, new_z, 1.0f));
+    }
+    return overlapping;
+}
@@ -0,0 +1,60 @@
+#ifndef CREATURE_SEPARATION_HPP
+#define CREATURE_SEPARATION_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include "creature_broad_phase.hpp"
+#include "creature_world.hpp"
+#include "job_system.hpp"
+
+#define SEPARATION_DISTANCE CREATURE_BOX_SIZE // Distância mínima entre centros (Creature::MIN_DISTANCE), a mesma das caixas da broad phase
+#define SEPARATION_SLOP 0.01f            // Sobreposição tolerada, para slimes já encostados não serem empurrados (e acordados) todo tick
+#define SEPARATION_ITERATIONS 4          // Passadas de relaxamento por tick
+#define SEPARATION_MAX_PAIRS 8192        // Pares resolvidos por tick; acima disso, em rodízio
+#define SEPARATION_PARALLEL_MIN_PAIRS 1024 // Cores com menos pares que isso rodam na thread que chama
+#define SEPARATION_COLORS 64             // A última cor recebe os pares que não couberam nas outras e roda sozinha
+
+// Afasta no plano XZ os slimes a menos de Creature::MIN_DISTANCE um do outro,
+// a partir dos pares de CreatureBroadPhase. Cada passada empurra os dois
+// slimes de cada par para longe um do outro, cada um metade do que falta (slimes capturados não se
+// movem e o outro anda tudo). Os pares são pintados de forma que nenhum slime
+// apareça duas vezes na mesma cor, então os pares de uma cor são resolvidos
+// em paralelo sem travas; as cores rodam em sequência. O custo por tick tem
+// teto: SEPARATION_ITERATIONS passadas por no máximo SEPARATION_MAX_PAIRS
+// pares.
+class CreatureSeparation {
+public:
+    typedef std::pair<CreatureHandle, CreatureHandle> HandlePair;
+
+    CreatureSeparation();
+
+    // Retorna quantos pares se sobrepunham no começo
+    size_t Solve(JobSystem& jobs, CreatureWorld& world, const std::vector<HandlePair>& pairs);
+
+private:
+    static const uint32_t NO_BODY = 0xFFFFFFFFu;
+
+    uint32_t Body(const CreatureWorld& world, CreatureHandle handle);
+    void Color();
+    void Relax(size_t begin, size_t end);
+
+    size_t cursor; // Onde começa a janela de pares do próximo tick, se houver mais que SEPARATION_MAX_PAIRS
+    uint32_t stamp;
+
+    // Slimes dos pares do tick
+    std::vector<CreatureKey> key;
+    std::vector<float> x, z;
+    std::vector<float> weight; // Fração da correção que cabe ao slime (0 se capturado)
+    std::vector<uint64_t> colors_used;
+    std::vector<uint32_t> body_slot; // Por índice do handle (SlotHandleIndex)
+    std::vector<uint32_t> body_stamp;
+
+    // Pares do tick, e depois de Color() agrupados por cor
+    std::vector<uint32_t> pair_a, pair_b, pair_color;
+    std::vector<uint32_t> ordered_a, ordered_b;
+    size_t color_start[SEPARATION_COLORS + 1];
+};
+
+#endif // CREATURE_SEPARATION_HPP
@@ -0,0 +1,368 @@
+#include "creature_update.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/constants.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/geometric.hpp>
+#include "random.hpp"
+#include "simd.hpp"
+#include "terrain.hpp"
+
+// Passo de rotação sem trigonometria: a distância angular entre rotation e
+// target no círculo é min(|d|, 2π - |d|), pois ambos ficam em [0, 2π].
+// Equivale ao glm::angle() entre os vetores (cos, sin) dos dois ângulos.
+static inline float RotationStep(float rotation, float target, float rotation_speed) {
+    float diff = target - rotation;
+    float dist = std::fabs(diff);
+    float circular = std::fmin(dist, glm::two_pi<float>() - dist);
+    if (circular <= rotation_speed) {
+        return target;
+    }
+    return rotation + std::copysign(rotation_speed, diff);
+}
+
+// Slime parado no chão (de altura "ground"), já virado para o alvo e dentro
+// do mapa: um passo não mudaria nada, então ele dorme até o próximo pulo agendado
+static inline bool IsSettled(const CreaturePool& pool, size_t i, float ground) {
+    return !pool.is_jumping[i] && pool.position_y[i] == ground && pool.vertical_velocity[i] == 0.0f &&
+           pool.rotation_angle[i] == pool.target_rotation_angle[i] &&
+           std::fabs(pool.position_x[i]) <= pool.map_limit && std::fabs(pool.position_z[i]) <= pool.map_limit;
+}
+
+//Versão escalar, usada no resto que não completa um bloco SIMD
+static inline void UpdateCreatureScalar(CreaturePool& pool, size_t i, float delta_t, float rotation_speed, std::vector<CreatureLanding>& landings) {
+    if (!pool.awake[i] || pool.captured[i]) {
+        return;
+    }
+    float ground = pool.GroundHeight(pool.position_x[i], pool.position_z[i]);
+    if (IsSettled(pool, i, ground)) {
+        pool.awake[i] = false;
+        return;
+    }
+    const SlimeParams& params = SLIME_TRAITS[pool.type[i]].params;
+    pool.vertical_velocity[i] += params.gravity * delta_t;
+    pool.position_y[i] += pool.vertical_velocity[i] * delta_t;
+
+    if (pool.position_y[i] < ground) {
+        pool.position_y[i] = ground;
+        pool.vertical_velocity[i] = 0.0f;
+        if (pool.is_jumping[i]) {
+            CreatureLanding landing = {(uint32_t)i, pool.tick};
+            landings.push_back(landing);
+        }
+        pool.is_jumping[i] = false;
+    }
+
+    if (pool.is_jumping[i]) {
+        pool.position_x[i] += pool.direction_x[i] * delta_t; // Move para frente na direção da rotação
+        pool.position_z[i] += pool.direction_z[i] * delta_t;
+    }
+
+    pool.position_x[i] = std::fmin(std::fmax(pool.position_x[i], -pool.map_limit), pool.map_limit);
+    pool.position_z[i] = std::fmin(std::fmax(pool.position_z[i], -pool.map_limit), pool.map_limit);
+
+    pool.rotation_angle[i] = RotationStep(pool.rotation_angle[i], pool.target_rotation_angle[i], rotation_speed);
+}
+
+#if defined(CREATURE_SIMD_AVX2) || defined(CREATURE_SIMD_SSE2)
+
+// Gravidade de cada slime do bloco. O caminho geral busca na tabela de
+// tipos slime a slime; o de um tipo só (TypeGravity) é uma constante.
+struct GatheredGravity {
+    inline vfloat operator()(const unsigned char* types) const {
+        float values[LANES];
+        for (size_t k = 0; k < LANES; k++) {
+            values[k] = SLIME_TRAITS[types[k]].params.gravity;
+        }
+        return VLoad(values);
+    }
+};
+
+template <Slime_Type T>
+struct TypeGravity {
+    inline vfloat operator()(const unsigned char*) const { return VSet(SlimeTypeTraits<T>::gravity); }
+};
+
+// Atualiza os blocos inteiros de [begin, end); "Gravity" diz de onde vem a
+// gravidade de cada bloco
+template <typename Gravity>
+static void UpdateCreatureBlocks(CreaturePool& pool, float delta_t, float rotation_speed, size_t begin, size_t end, Gravity gravity_of, std::vector<CreatureLanding>& landings) {
+    const vfloat dt = VSet(delta_t);
+    const vfloat zero = VSet(0.0f);
+    const vfloat flat = VSet(Creature::GROUND_LEVEL);
+    const Terrain* terrain = pool.terrain;
+    const vfloat map_min = VSet(-pool.map_limit);
+    const vfloat map_max = VSet(pool.map_limit);
+    const vfloat speed = VSet(rotation_speed);
+    const vfloat two_pi = VSet(glm::two_pi<float>());
+    const vfloat sign_bit = VSet(-0.0f);
+
+    size_t i = begin;
+    for (; i + LANES <= end; i += LANES) {
+        // Só slimes acordados e fora de captura são atualizados; bloco todo dormindo é pulado
+        vfloat active = VAndNot(VMaskFromBytes(&pool.captured[i]), VMaskFromBytes(&pool.awake[i]));
+        if (VMoveMask(active) == 0) {
+            continue;
+        }
+
+        // Quem começa o passo parado (ver IsSettled) dorme depois dele
+        vfloat vy = VLoad(&pool.vertical_velocity[i]);
+        vfloat y = VLoad(&pool.position_y[i]);
+        vfloat x = VLoad(&pool.position_x[i]);
+        vfloat z = VLoad(&pool.position_z[i]);
+        vfloat rotation = VLoad(&pool.rotation_angle[i]);
+        vfloat target = VLoad(&pool.target_rotation_angle[i]);
+        vfloat jumping = VMaskFromBytes(&pool.is_jumping[i]);
+        // Chão sob o bloco todo de uma vez, como em GroundHeight()
+        vfloat ground = terrain ? VAdd(flat, terrain->HeightBlock(x, z)) : flat;
+        vfloat inside = VAnd(VAnd(VLessEqual(map_min, x), VLessEqual(x, map_max)), VAnd(VLessEqual(map_min, z), VLessEqual(z, map_max)));
+        vfloat settled = VAnd(VAndNot(jumping, active), VAnd(VAnd(VEqual(y, ground), VEqual(vy, zero)), VAnd(VEqual(rotation, target), inside)));
+
+        // Gravidade e colisão com o chão
+        vfloat gravity = gravity_of(&pool.type[i]);
+        vfloat new_vy = VAdd(vy, VMul(gravity, dt));
+        vfloat new_y = VAdd(y, VMul(new_vy, dt));
+        vfloat landed = VAnd(active, VLess(new_y, ground));
+        new_y = VSelect(landed, ground, new_y);
+        new_vy = VSelect(landed, zero, new_vy);
+        VStore(&pool.vertical_velocity[i], VSelect(active, new_vy, vy));
+        VStore(&pool.position_y[i], VSelect(active, new_y, y));
+
+        // Pousos de quem estava pulando vão para a agenda de pulos
+        int landed_bits = VMoveMask(VAnd(landed, jumping));
+        for (size_t k = 0; landed_bits != 0; k++, landed_bits >>= 1) {
+            if (landed_bits & 1) {
+                pool.is_jumping[i + k] = false;
+                CreatureLanding landing = {(uint32_t)(i + k), pool.tick};
+                landings.push_back(landing);
+            }
+        }
+
+        // Movimento horizontal durante o pulo e limite do mapa
+        vfloat moving = VAnd(active, VMaskFromBytes(&pool.is_jumping[i]));
+        vfloat new_x = VAdd(x, VAnd(moving, VMul(VLoad(&pool.direction_x[i]), dt)));
+        vfloat new_z = VAdd(z, VAnd(moving, VMul(VLoad(&pool.direction_z[i]), dt)));
+        new_x = VMin(VMax(new_x, map_min), map_max);
+        new_z = VMin(VMax(new_z, map_min), map_max);
+        VStore(&pool.position_x[i], VSelect(active, new_x, x));
+        VStore(&pool.position_z[i], VSelect(active, new_z, z));
+
+        // Rotação sem desvios nem trigonometria (ver RotationStep)
+        vfloat diff = VSub(target, rotation);
+        vfloat dist = VAndNot(sign_bit, diff);
+        vfloat circular = VMin(dist, VSub(two_pi, dist));
+        vfloat stepped = VAdd(rotation, VOr(VAnd(diff, sign_bit), speed));
+        vfloat new_rotation = VSelect(VLessEqual(circular, speed), target, stepped);
+        VStore(&pool.rotation_angle[i], VSelect(active, new_rotation, rotation));
+
+        int settled_bits = VMoveMask(settled);
+        for (size_t k = 0; settled_bits != 0; k++, settled_bits >>= 1) {
+            if (settled_bits & 1) {
+                pool.awake[i + k] = false;
+            }
+        }
+    }
+}
+
+//Versão de UpdateCreatureBlocks() com a gravidade de um tipo só, escolhida por DispatchSlimeType()
+struct TypedBlocks {
+    CreaturePool* pool;
+    float delta_t, rotation_speed;
+    size_t begin, end;
+    std::vector<CreatureLanding>* landings;
+    template <Slime_Type T> void Visit() const {
+        UpdateCreatureBlocks(*pool, delta_t, rotation_speed, begin, end, TypeGravity<T>(), *landings);
+    }
+};
+
+// Como cada tipo nasce e vive no seu bioma, o pool de um chunk é quase todo
+// de um tipo: as sequências de blocos de um tipo só vão inteiras para a
+// versão especializada, com um desvio por sequência, e só os blocos
+// misturados buscam a gravidade slime a slime.
+static void UpdateCreatureBlockRuns(CreaturePool& pool, float delta_t, float rotation_speed, size_t begin, size_t end, std::vector<CreatureLanding>& landings) {
+    const unsigned char* types = pool.type.data();
+    size_t i = begin;
+    while (i + LANES <= end) {
+        unsigned char type = types[i];
+        size_t run_end = i;
+        while (run_end + LANES <= end && std::count(types + run_end, types + run_end + LANES, type) == (std::ptrdiff_t)LANES) {
+            run_end += LANES;
+        }
+        if (run_end == i) {
+            UpdateCreatureBlocks(pool, delta_t, rotation_speed, i, i + LANES, GatheredGravity(), landings);
+            i += LANES;
+            continue;
+        }
+        TypedBlocks blocks = {&pool, delta_t, rotation_speed, i, run_end, &landings};
+        DispatchSlimeType(Slime_Type(type), blocks);
+        i = run_end;
+    }
+}
+
+#endif
+
+void UpdateCreatureRange(CreaturePool& pool, float delta_t, size_t begin, size_t end, std::vector<CreatureLanding>& landings) {
+    float rotation_speed = glm::radians(CREATURE_ROTATION_SPEED) * delta_t; // Velocidade de rotação
+    size_t i = begin;
+
+#if defined(CREATURE_SIMD_AVX2) || defined(CREATURE_SIMD_SSE2)
+    UpdateCreatureBlockRuns(pool, delta_t, rotation_speed, begin, end, landings);
+    i = begin + (end - begin) / LANES * LANES;
+#endif
+
+    for (; i < end; i++) {
+        UpdateCreatureScalar(pool, i, delta_t, rotation_speed, landings);
+    }
+    std::fill(pool.sim_tick.begin() + begin, pool.sim_tick.begin() + end, pool.tick + 1);
+}
+
+//Copia um estado previsto para o slime
+static inline void ApplyMotion(CreaturePool& pool, size_t i, const CreatureMotion& motion) {
+    pool.position_x[i] = motion.x;
+    pool.position_y[i] = motion.y;
+    pool.position_z[i] = motion.z;
+    pool.vertical_velocity[i] = motion.vertical_velocity;
+    pool.rotation_angle[i] = motion.rotation_angle;
+    pool.is_jumping[i] = motion.is_jumping;
+}
+
+static inline void SetPreviousState(CreaturePool& pool, size_t i, float x, float y, float z, float rotation_angle) {
+    pool.previous_position_x[i] = x;
+    pool.previous_position_y[i] = y;
+    pool.previous_position_z[i] = z;
+    pool.previous_rotation_angle[i] = rotation_angle;
+}
+
+// Leva o slime atrasado até o tick atual de uma vez. Um pouso no meio da
+// janela é agendado pelo tick em que aconteceu. O estado anterior do desenho
+// é o previsto um tick antes, para a interpolação não saltar.
+static void CatchUpCreature(CreaturePool& pool, size_t i, float delta_t, uint32_t steps, std::vector<CreatureLanding>& landings) {
+    if (IsSettled(pool, i, pool.GroundHeight(pool.position_x[i], pool.position_z[i]))) {
+        SetPreviousState(pool, i, pool.position_x[i], pool.position_y[i], pool.position_z[i], pool.rotation_angle[i]);
+        pool.awake[i] = false;
+        return;
+    }
+    CreatureMotion previous;
+    CreatureMotion motion = pool.Predict(i, float(steps), delta_t, &previous);
+    if (pool.is_jumping[i] && !motion.is_jumping) {
+        CreatureLanding landing = {(uint32_t)i, pool.tick + 1 - (uint32_t)motion.grounded_steps};
+        landings.push_back(landing);
+    }
+    ApplyMotion(pool, i, motion);
+    SetPreviousState(pool, i, previous.x, previous.y, previous.z, previous.rotation_angle);
+}
+
+//Atualiza um slime acordado pelo LOD: um passo normal se está em dia, senão alcança o tick atual
+static inline void UpdateCreatureLod(CreaturePool& pool, size_t i, float delta_t, float rotation_speed, std::vector<CreatureLanding>& landings) {
+    if (!pool.awake[i]) {
+        return;
+    }
+    uint32_t steps = pool.tick + 1 - pool.sim_tick[i];
+    if (steps == 1) {
+        UpdateCreatureScalar(pool, i, delta_t, rotation_speed, landings);
+    } else {
+        CatchUpCreature(pool, i, delta_t, steps, landings);
+    }
+    pool.sim_tick[i] = pool.tick + 1;
+}
+
+void UpdateCreatureRangeLod(CreaturePool& pool, float delta_t, const CreatureLod& lod, size_t begin, size_t end, std::vector<CreatureLanding>& landings) {
+    const float rotation_speed = glm::radians(CREATURE_ROTATION_SPEED) * delta_t;
+    const float near_squared = lod.near_distance * lod.near_distance;
+    const uint32_t buckets = std::max(lod.buckets, 1u);
+    for (size_t run = begin; run < end;) {
+        size_t run_end = std::min((run / CREATURE_LOD_RUN + 1) * CREATURE_LOD_RUN, end);
+        if ((run / CREATURE_LOD_RUN + pool.tick) % buckets == 0) {
+            // Grupo da vez: todos os slimes acordados do trecho
+            for (size_t i = run; i < run_end; i++) {
+                UpdateCreatureLod(pool, i, delta_t, rotation_speed, landings);
+            }
+        } else {
+            // Fora da vez só os próximos
+            for (size_t i = run; i < run_end; i++) {
+                float dx = pool.position_x[i] - lod.center.x;
+                float dz = pool.position_z[i] - lod.center.z;
+                if (dx * dx + dz * dz < near_squared) {
+                    UpdateCreatureLod(pool, i, delta_t, rotation_speed, landings);
+                }
+            }
+        }
+        run = run_end;
+    }
+}
+
+size_t StartDueJumps(CreaturePool& pool, std::vector<uint32_t>& started) {
+    // Os vencidos entram no fim de "started" e só os que pulam ficam lá
+    size_t first = started.size();
+    pool.jumps.Advance(pool.tick, started);
+    size_t kept = first;
+    for (size_t k = first; k < started.size(); k++) {
+        uint32_t i = started[k];
+        if (pool.captured[i] || pool.is_jumping[i]) {
+            // Capturado não pula; tenta de novo como se tivesse ficado no chão
+            pool.ScheduleJump(i, pool.tick);
+            continue;
+        }
+        if (pool.awake[i] && pool.sim_tick[i] < pool.tick) {
+            // Atrasado pelo LOD (ainda girando): alcança o início do tick antes de pular
+            CreatureMotion motion = pool.Predict(i, float(pool.tick - pool.sim_tick[i]), pool.tick_step);
+            ApplyMotion(pool, i, motion);
+            SetPreviousState(pool, i, motion.x, motion.y, motion.z, motion.rotation_angle);
+            pool.sim_tick[i] = pool.tick;
+        }
+        pool.Jump(i);
+        started[kept++] = i;
+    }
+    started.resize(kept);
+    return kept - first;
+}
+
+void ScheduleLandings(CreaturePool& pool, const std::vector<CreatureLanding>& landings) {
+    for (size_t k = 0; k < landings.size(); k++) {
+        pool.ScheduleJump(landings[k].creature, landings[k].tick);
+    }
+}
+
+//Só slimes acordados e simulados neste tick podem ter mudado de célula
+static void SyncUpdatedCreatures(CreaturePool& pool) {
+    for (size_t i = 0; i < pool.Size(); i++) {
+        if (pool.sim_tick[i] == pool.tick + 1 && pool.awake[i]) {
+            pool.grid.Move((uint32_t)i, pool.position_x[i], pool.position_y[i], pool.position_z[i]);
+            pool.MarkMoved(i);
+        }
+    }
+}
+
+// Pulo mais alto pela distância ao jogador; em empate fica o menor índice
+static LoudestJump FindLoudestJump(const CreaturePool& pool, const std::vector<uint32_t>& started, glm::vec3 listener, float max_distance) {
+    LoudestJump loudest = {-1, 0.0f, -1, 0};
+    for (size_t k = 0; k < started.size(); k++) {
+        uint32_t i = started[k];
+        glm::vec3 slime_position(pool.position_x[i], pool.position_y[i], pool.position_z[i]);
+        float volume = 1.0f - glm::clamp(glm::distance(listener, slime_position) / max_distance, 0.0f, 1.0f);
+        if (volume > loudest.volume || (volume == loudest.volume && volume > 0.0f && int(i) < loudest.creature)) {
+            loudest.volume = volume;
+            loudest.creature = int(i);
+        }
+    }
+    return loudest;
+}
+
+LoudestJump UpdateCreaturesSerial(CreaturePool& pool, float delta_t, glm::vec3 listener, float max_distance, const CreatureLod& lod, const CreatureFlock& flock, CreatureScratch& scratch) {
+    scratch.started.clear();
+    scratch.landings.clear();
+    pool.tick_step = delta_t;
+    StartDueJumps(pool, scratch.started);
+    SteerJumps(pool, scratch.started, flock, scratch.flock);
+    LoudestJump loudest = FindLoudestJump(pool, scratch.started, listener, max_distance);
+    if (lod.enabled) {
+        UpdateCreatureRangeLod(pool, delta_t, lod, 0, pool.Size(), scratch.landings);
+    } else {
+        UpdateCreatureRange(pool, delta_t, 0, pool.Size(), scratch.landings);
+    }
+    ScheduleLandings(pool, scratch.landings);
+    SyncUpdatedCreatures(pool);
+    pool.tick++;
+    return loudest;
+}
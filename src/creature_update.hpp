@@ -0,0 +1,79 @@
+#ifndef CREATURE_UPDATE_HPP
+#define CREATURE_UPDATE_HPP
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+#include <glm/vec3.hpp>
+#include "creature_pool.hpp"
+#include "creature_flock.hpp"
+
+#define CREATURE_LOD_NEAR_DISTANCE 64.0f // Metros; cobre o cone da arma (57) e o som dos pulos (50)
+#define CREATURE_LOD_BUCKETS 20          // Slimes distantes são atualizados a cada 20 ticks
+#define CREATURE_LOD_RUN 64              // Slimes seguidos no pool que caem no mesmo grupo do rodízio
+
+// Nível de detalhe da simulação: slimes a menos de near_distance de "center"
+// (no plano XZ) são atualizados todo tick; os outros ficam em "buckets"
+// grupos em rodízio e cada grupo é atualizado em um tick de cada "buckets".
+// Os grupos são trechos de CREATURE_LOD_RUN índices do pool, para a memória
+// ser lida em sequência; um slime que muda de índice (Remove()) só muda de
+// grupo, já que sim_tick diz quantos ticks ele perdeu. Ao ser alcançado, o
+// slime avança de uma vez os ticks que perdeu (CreaturePool::Predict()), e o
+// desenho prevê a posição dele entre um alcance e outro, então o arco do
+// pulo continua suave. Os pulos vêm da agenda, no tick certo mesmo longe.
+struct CreatureLod {
+    bool enabled;
+    glm::vec3 center;
+    float near_distance;
+    uint32_t buckets;
+};
+
+//Slime cujo pulo é ouvido mais alto pelo jogador (creature = -1 se nenhum)
+struct LoudestJump {
+    int creature;
+    float volume;
+    int chunk; // Chunk do slime em um CreatureWorld (-1 se veio de um pool só)
+    uint32_t handle; // CreatureHandle do slime em um CreatureWorld (0 se veio de um pool só)
+};
+
+//Slime que pousou e o tick do pouso, para agendar o próximo pulo
+struct CreatureLanding {
+    uint32_t creature;
+    uint32_t tick;
+};
+
+// Vetores de rascunho de um tick, reaproveitados entre ticks; cada thread
+// que atualiza um pool ao mesmo tempo que outras usa os seus
+struct CreatureScratch {
+    std::vector<uint32_t> started;
+    std::vector<CreatureLanding> landings;
+    FlockScratch flock;
+};
+
+// Etapas do tick, para quem divide a atualização em partes.
+// Começa os pulos que vencem em pool.tick e acrescenta os slimes a "started".
+size_t StartDueJumps(CreaturePool& pool, std::vector<uint32_t>& started);
+// Física do intervalo [begin, end) do pool, em blocos de 4 (SSE2) ou 8 (AVX2)
+// slimes por instrução, com versão escalar quando não há SIMD. Blocos todos
+// dormindo são pulados. Não mexe na agenda, na grade nem em pool.tick, então
+// intervalos diferentes podem ser atualizados em paralelo; os pousos vão
+// para "landings" e depois para ScheduleLandings().
+void UpdateCreatureRange(CreaturePool& pool, float delta_t, size_t begin, size_t end, std::vector<CreatureLanding>& landings);
+// Versão com LOD: só atualiza os slimes próximos e o grupo da vez.
+void UpdateCreatureRangeLod(CreaturePool& pool, float delta_t, const CreatureLod& lod, size_t begin, size_t end, std::vector<CreatureLanding>& landings);
+void ScheduleLandings(CreaturePool& pool, const std::vector<CreatureLanding>& landings);
+
+// Um tick da simulação dos slimes de um pool, na thread que chama: começa os
+// pulos que vencem na agenda (pool.jumps), que seguem o bando se
+// flock.enabled (ver SteerJumps()), atualiza a física dos slimes acordados
+// (gravidade, chão, movimento horizontal, limite do mapa e rotação, com o LOD
+// se lod.enabled), agenda o próximo pulo de quem pousou, atualiza pool.grid e
+// avança pool.tick. Slimes parados dormem até o próximo pulo, então um
+// rancho quieto quase não custa nada. Vários pools são atualizados em
+// paralelo, um por tarefa, cada um com o seu "scratch" (ver
+// CreatureWorld::Update()). Retorna, entre os slimes que começaram a pular,
+// o pulo mais alto a partir de "listener" (o de menor índice em caso de
+// empate).
+LoudestJump UpdateCreaturesSerial(CreaturePool& pool, float delta_t, glm::vec3 listener, float max_distance, const CreatureLod& lod, const CreatureFlock& flock, CreatureScratch& scratch);
+
+#endif // CREATURE_UPDATE_HPP
@@ -0,0 +1,362 @@
+#include "creature_world.hpp"
+#include <algorithm>
+#include <cmath>
+#include "curve.hpp"
+
+CreatureWorld::CreatureWorld(uint64_t seed) : seed(seed), next_id(0), tracking(false) {
+    for (size_t c = 0; c < WORLD_CHUNK_COUNT; c++) {
+        chunks[c].seed = seed;
+        virtuals[c].active = false;
+        virtuals[c].key = 0;
+        std::fill(virtuals[c].count, virtuals[c].count + SLIME_TYPE_COUNT, 0u);
+    }
+    SetMapSize(MAP_LIMIT + 1.0f, MAP_LIMIT + 1.0f);
+}
+
+void CreatureWorld::SetMapSize(float width, float length) {
+    map_width = width;
+    map_length = length;
+    tile_width = 2.0f * width / WORLD_TILES_PER_SIDE;
+    tile_length = 2.0f * length / WORLD_TILES_PER_SIDE;
+    // Um metro de folga, como a grade do pool sozinho, para quem ainda não trocou de chunk
+    float half_size = 0.5f * std::max(tile_width, tile_length) + 1.0f;
+    for (size_t c = 0; c < WORLD_CHUNK_COUNT; c++) {
+        // Os chunks da borda também ficam com o que está fora do mapa
+        size_t column = c % WORLD_TILES_PER_SIDE, row = c / WORLD_TILES_PER_SIDE;
+        bounds[c].min_x = column == 0 ? -INFINITY : -width + tile_width * column;
+        bounds[c].max_x = column == WORLD_TILES_PER_SIDE - 1 ? INFINITY : -width + tile_width * (column + 1);
+        bounds[c].min_z = row == 0 ? -INFINITY : -length + tile_length * row;
+        bounds[c].max_z = row == WORLD_TILES_PER_SIDE - 1 ? INFINITY : -length + tile_length * (row + 1);
+        glm::vec2 center(-width + tile_width * (c % WORLD_TILES_PER_SIDE + 0.5f),
+                         -length + tile_length * (c / WORLD_TILES_PER_SIDE + 0.5f));
+        chunks[c].map_limit = width - 1.0f;
+        chunks[c].grid.Resize(half_size, GRID_CELL_SIZE, center);
+    }
+}
+
+void CreatureWorld::SetTerrain(const Terrain* terrain) {
+    for (size_t c = 0; c < WORLD_CHUNK_COUNT; c++) {
+        chunks[c].terrain = terrain;
+    }
+}
+
+float CreatureWorld::GroundHeight(float x, float z) const {
+    return chunks[0].GroundHeight(x, z);
+}
+
+size_t CreatureWorld::ChunkCount() const {
+    return WORLD_CHUNK_COUNT;
+}
+
+CreaturePool& CreatureWorld::Chunk(size_t c) {
+    return chunks[c];
+}
+
+const CreaturePool& CreatureWorld::Chunk(size_t c) const {
+    return chunks[c];
+}
+
+// Coluna e linha de biomas pelas mesmas bordas de FindLeaving(), para um
+// slime na borda nunca ficar entre dois chunks
+size_t CreatureWorld::Column(float x) const {
+    size_t column = 0;
+    for (size_t k = 1; k < WORLD_TILES_PER_SIDE; k++) {
+        column += x >= bounds[k].min_x;
+    }
+    return column;
+}
+
+size_t CreatureWorld::Row(float z) const {
+    size_t row = 0;
+    for (size_t k = 1; k < WORLD_TILES_PER_SIDE; k++) {
+        row += z >= bounds[k * WORLD_TILES_PER_SIDE].min_z;
+    }
+    return row;
+}
+
+size_t CreatureWorld::ChunkAt(float x, float z) const {
+    return Row(z) * WORLD_TILES_PER_SIDE + Column(x);
+}
+
+size_t CreatureWorld::Size() const {
+    size_t size = 0;
+    for (size_t c = 0; c < WORLD_CHUNK_COUNT; c++) {
+        size += chunks[c].Size();
+    }
+    return size;
+}
+
+size_t CreatureWorld::Population() const {
+    size_t population = Size();
+    for (size_t c = 0; c < WORLD_CHUNK_COUNT; c++) {
+        population += VirtualCount(c);
+    }
+    return population;
+}
+
+uint32_t CreatureWorld::Tick() const {
+    return chunks[0].tick;
+}
+
+CreatureHandle CreatureWorld::Add(Slime_Type type, float x, float y, float z) {
+    if (slots.Full()) {
+        return CREATURE_HANDLE_NONE;
+    }
+    size_t c = ChunkAt(x, z);
+    size_t i = chunks[c].Add(type, x, y, z, next_id++);
+    CreatureHandle handle = slots.Insert(MakeCreatureKey(c, i));
+    chunks[c].handle[i] = handle;
+    if (tracking) {
+        changes.added.push_back(handle);
+    }
+    return handle;
+}
+
+void CreatureWorld::Moved(size_t c, size_t i) {
+    if (i < chunks[c].Size()) {
+        slots.Set(chunks[c].handle[i], MakeCreatureKey(c, i));
+    }
+}
+
+void CreatureWorld::Remove(CreatureHandle handle) {
+    const CreatureKey* key = slots.Get(handle);
+    if (key == NULL) {
+        return;
+    }
+    size_t c = CreatureKeyChunk(*key), i = CreatureKeyIndex(*key);
+    if (tracking) {
+        changes.removed.push_back(handle);
+    }
+    slots.Remove(handle);
+    chunks[c].Remove(i);
+    Moved(c, i);
+}
+
+CreatureKey CreatureWorld::Find(CreatureHandle handle) const {
+    const CreatureKey* key = slots.Get(handle);
+    return key != NULL ? *key : CREATURE_KEY_NONE;
+}
+
+bool CreatureWorld::Contains(CreatureHandle handle) const {
+    return slots.Contains(handle);
+}
+
+glm::vec4 CreatureWorld::GetPosition(CreatureHandle handle) const {
+    CreatureKey key = Find(handle);
+    return chunks[CreatureKeyChunk(key)].GetPosition(CreatureKeyIndex(key));
+}
+
+bool CreatureWorld::AnyInRadius(float x, float z, float radius) const {
+    for (size_t row = Row(z - radius); row <= Row(z + radius); row++) {
+        for (size_t column = Column(x - radius); column <= Column(x + radius); column++) {
+            if (chunks[row * WORLD_TILES_PER_SIDE + column].grid.AnyInRadius(x, z, radius)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+//Troca os índices que a grade de um chunk acrescentou a "out" pelos handles
+static void MakeHandles(const CreaturePool& pool, size_t first, std::vector<uint32_t>& out) {
+    for (size_t k = first; k < out.size(); k++) {
+        out[k] = pool.handle[out[k]];
+    }
+}
+
+size_t CreatureWorld::QueryAABB(glm::vec3 min, glm::vec3 max, std::vector<CreatureHandle>& out) const {
+    size_t first = out.size();
+    for (size_t row = Row(min.z); row <= Row(max.z); row++) {
+        for (size_t column = Column(min.x); column <= Column(max.x); column++) {
+            size_t c = row * WORLD_TILES_PER_SIDE + column;
+            size_t chunk_first = out.size();
+            chunks[c].grid.QueryAABB(min, max, out);
+            MakeHandles(chunks[c], chunk_first, out);
+        }
+    }
+    return out.size() - first;
+}
+
+size_t CreatureWorld::QueryCone(const WeaponCone& cone, std::vector<CreatureHandle>& out) const {
+    size_t first = out.size();
+    for (size_t row = Row(cone.box_min.z); row <= Row(cone.box_max.z); row++) {
+        for (size_t column = Column(cone.box_min.x); column <= Column(cone.box_max.x); column++) {
+            size_t c = row * WORLD_TILES_PER_SIDE + column;
+            size_t chunk_first = out.size();
+            chunks[c].grid.QueryCone(cone, out);
+            MakeHandles(chunks[c], chunk_first, out);
+        }
+    }
+    return out.size() - first;
+}
+
+void CreatureWorld::SaveRenderState() {
+    for (size_t c = 0; c < WORLD_CHUNK_COUNT; c++) {
+        chunks[c].SaveRenderState();
+    }
+}
+
+void CreatureChanges::Clear() {
+    added.clear();
+    removed.clear();
+    moved.clear();
+}
+
+void CreatureWorld::TrackChanges() {
+    tracking = true;
+    for (size_t c = 0; c < WORLD_CHUNK_COUNT; c++) {
+        chunks[c].track_moves = true;
+    }
+}
+
+bool CreatureWorld::TracksChanges() const {
+    return tracking;
+}
+
+// Troca os vetores com "out", para os dois lados reaproveitarem a memória
+void CreatureWorld::TakeChanges(CreatureChanges& out) {
+    changes.moved.clear();
+    for (size_t c = 0; c < WORLD_CHUNK_COUNT; c++) {
+        std::vector<uint32_t>& moved = chunks[c].moved_handles;
+        changes.moved.insert(changes.moved.end(), moved.begin(), moved.end());
+        moved.clear();
+    }
+    std::swap(changes.added, out.added);
+    std::swap(changes.removed, out.removed);
+    std::swap(changes.moved, out.moved);
+    changes.Clear();
+}
+
+void CreatureWorld::CatchUp(float seconds, float delta_t) {
+    for (size_t c = 0; c < WORLD_CHUNK_COUNT; c++) {
+        chunks[c].CatchUp(seconds, delta_t);
+        FindLeaving(c);
+    }
+    Handoff();
+}
+
+bool CreatureWorld::IsVirtual(size_t c) const {
+    return virtuals[c].active;
+}
+
+uint32_t CreatureWorld::VirtualCount(size_t c) const {
+    uint32_t total = 0;
+    for (int t = 0; t < SLIME_TYPE_COUNT; t++) {
+        total += virtuals[c].count[t];
+    }
+    return total;
+}
+
+float CreatureWorld::ChunkDistance(size_t c, float x, float z) const {
+    float dx = std::max(std::max(bounds[c].min_x - x, x - bounds[c].max_x), 0.0f);
+    float dz = std::max(std::max(bounds[c].min_z - z, z - bounds[c].max_z), 0.0f);
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+bool CreatureWorld::Collapse(size_t c, uint32_t key) {
+    CreaturePool& pool = chunks[c];
+    for (size_t i = 0; i < pool.Size(); i++) {
+        if (pool.captured[i]) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < pool.Size(); i++) {
+        virtuals[c].count[pool.type[i]]++;
+    }
+    virtuals[c].active = true;
+    virtuals[c].key = key;
+    for (size_t i = 0; i < pool.Size(); i++) {
+        if (tracking) {
+            changes.removed.push_back(pool.handle[i]);
+        }
+        slots.Remove(pool.handle[i]);
+    }
+    pool.moved_handles.clear(); // Os handles já estão em "removed"
+    pool.Clear();
+    pool.ShrinkToFit();
+    return true;
+}
+
+void CreatureWorld::AddVirtual(size_t c, Slime_Type type) {
+    virtuals[c].count[type]++;
+    next_id++;
+}
+
+void CreatureWorld::TakeVirtual(size_t c, uint32_t count[SLIME_TYPE_COUNT], uint32_t& key) {
+    std::copy(virtuals[c].count, virtuals[c].count + SLIME_TYPE_COUNT, count);
+    std::fill(virtuals[c].count, virtuals[c].count + SLIME_TYPE_COUNT, 0u);
+    key = virtuals[c].key;
+    virtuals[c].active = false;
+}
+
+void CreatureWorld::ReturnVirtual(size_t c, const uint32_t count[SLIME_TYPE_COUNT]) {
+    for (int t = 0; t < SLIME_TYPE_COUNT; t++) {
+        virtuals[c].count[t] += count[t];
+    }
+}
+
+//Slimes do chunk que estão no bioma de outro, seja por um pulo ou por SetPosition()
+void CreatureWorld::FindLeaving(size_t c) {
+    const CreaturePool& pool = chunks[c];
+    const ChunkBounds& b = bounds[c];
+    leaving[c].clear();
+    for (size_t i = 0; i < pool.Size(); i++) {
+        float x = pool.position_x[i], z = pool.position_z[i];
+        if ((x < b.min_x) | (x >= b.max_x) | (z < b.min_z) | (z >= b.max_z)) {
+            leaving[c].push_back((uint32_t)i);
+        }
+    }
+}
+
+// Em ordem de chunk e, dentro dele, de índice decrescente: o Remove() de cada
+// troca só move para a posição liberada um slime que fica no chunk ou que já
+// foi passado adiante, então o resultado não depende das threads. Quem
+// chega a um chunk virtual entra só na conta dele e perde o handle.
+size_t CreatureWorld::Handoff() {
+    size_t moved = 0;
+    for (size_t c = 0; c < WORLD_CHUNK_COUNT; c++) {
+        for (size_t k = leaving[c].size(); k-- > 0;) {
+            uint32_t i = leaving[c][k];
+            CreaturePool& source = chunks[c];
+            size_t destination = ChunkAt(source.position_x[i], source.position_z[i]);
+            if (virtuals[destination].active) {
+                virtuals[destination].count[source.type[i]]++;
+                if (tracking) {
+                    changes.removed.push_back(source.handle[i]);
+                }
+                slots.Remove(source.handle[i]);
+                source.Remove(i);
+            } else {
+                size_t taken = chunks[destination].TakeFrom(source, i);
+                slots.Set(chunks[destination].handle[taken], MakeCreatureKey(destination, taken));
+                chunks[destination].MarkMoved(taken);
+            }
+            Moved(c, i);
+            moved++;
+        }
+    }
+    return moved;
+}
+
+LoudestJump CreatureWorld::Update(JobSystem& jobs, float delta_t, glm::vec3 listener, float max_distance, const CreatureLod& lod, const CreatureFlock& flock) {
+    LoudestJump chunk_loudest[WORLD_CHUNK_COUNT];
+    jobs.ParallelFor(WORLD_CHUNK_COUNT, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            chunk_loudest[c] = UpdateCreaturesSerial(chunks[c], delta_t, listener, max_distance, lod, flock, scratch[c]);
+            chunk_loudest[c].chunk = (int)c;
+            if (chunk_loudest[c].creature >= 0) {
+                chunk_loudest[c].handle = chunks[c].handle[chunk_loudest[c].creature];
+            }
+            FindLeaving(c);
+        }
+    });
+    Handoff();
+
+    LoudestJump loudest = {-1, 0.0f, -1, 0};
+    for (size_t c = 0; c < WORLD_CHUNK_COUNT; c++) {
+        if (chunk_loudest[c].creature >= 0 && chunk_loudest[c].volume > loudest.volume) {
+            loudest = chunk_loudest[c];
+        }
+    }
+    return loudest;
+}
@@ -0,0 +1,167 @@
+#ifndef CREATURE_WORLD_HPP
+#define CREATURE_WORLD_HPP
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include "creature_pool.hpp"
+#include "creature_update.hpp"
+#include "job_system.hpp"
+#include "slot_map.hpp"
+
+#define WORLD_TILES_PER_SIDE 3 // Biomas por lado do mapa
+#define WORLD_CHUNK_COUNT 9
+#define WORLD_CHUNK_BITS 4     // Bits do chunk em uma CreatureKey
+#define WORLD_VIRTUAL_DISTANCE 150.0f // Metros do jogador até a borda do bioma para ele ter slimes de verdade
+#define WORLD_VIRTUAL_MARGIN 50.0f    // Folga antes de recolher, para não alternar na borda
+
+// Onde um slime do mundo está agora: o chunk nos bits baixos e o índice no
+// pool do chunk no resto. Só vale até o próximo Remove() ou troca de chunk;
+// para guardar um slime entre ticks use o CreatureHandle dele.
+typedef uint32_t CreatureKey;
+#define CREATURE_KEY_NONE 0xFFFFFFFFu
+
+// Um slime do mundo enquanto ele existir, não importa quantas vezes ele mude
+// de índice ou de chunk. Depois que ele sai (capturado, recolhido em um chunk
+// virtual), Find() devolve CREATURE_KEY_NONE para o handle antigo.
+typedef SlotHandle CreatureHandle;
+#define CREATURE_HANDLE_NONE SLOT_HANDLE_NONE
+
+inline CreatureKey MakeCreatureKey(size_t chunk, size_t index) {
+    return (CreatureKey)(index << WORLD_CHUNK_BITS | chunk);
+}
+
+inline size_t CreatureKeyChunk(CreatureKey key) {
+    return key & ((1u << WORLD_CHUNK_BITS) - 1);
+}
+
+inline size_t CreatureKeyIndex(CreatureKey key) {
+    return key >> WORLD_CHUNK_BITS;
+}
+
+// Slimes que nasceram, saíram ou mudaram de lugar (também de chunk) desde o
+// último CreatureWorld::TakeChanges(), pelos handles. Um handle pode aparecer
+// mais de uma vez, e em "added" e "removed" do mesmo intervalo.
+struct CreatureChanges {
+    std::vector<CreatureHandle> added;
+    std::vector<CreatureHandle> removed;
+    std::vector<CreatureHandle> moved;
+    void Clear();
+};
+
+// O mapa dividido nos 3x3 biomas em que cada tipo de slime nasce, cada bioma
+// um chunk da simulação com seu próprio CreaturePool: a grade cobre só o
+// bioma e a agenda de pulos só os slimes dele, então os chunks são
+// atualizados em paralelo sem dividir nada. O slime que pula para fora do
+// bioma passa para o chunk vizinho no fim do tick, com todo o estado. Os ids
+// vêm de um contador do mundo, então os sorteios de um slime não mudam quando
+// ele troca de chunk, e a mesma seed gera sempre o mesmo rancho.
+//
+// Um chunk longe do jogador pode ficar virtual: o pool fica vazio e o chunk
+// guarda só quantos slimes de cada tipo tem e uma chave de sorteio, com que
+// StreamVirtualChunks() (slime_types.hpp) recoloca os slimes quando o jogador
+// volta. Slimes que pulam ou nascem em um chunk virtual só aumentam a conta.
+class CreatureWorld {
+public:
+    CreatureWorld(uint64_t seed = 0);
+
+    // Mapa em [-map_width, map_width] x [-map_length, map_length]; redimensiona
+    // as grades, então deve vir antes dos primeiros slimes
+    void SetMapSize(float map_width, float map_length);
+    // Chão de todos os chunks; o relevo precisa viver tanto quanto o mundo
+    void SetTerrain(const Terrain* terrain);
+    float GroundHeight(float x, float z) const; // Altura do chão de um slime em (x, z)
+
+    size_t ChunkCount() const;
+    CreaturePool& Chunk(size_t chunk);
+    const CreaturePool& Chunk(size_t chunk) const;
+    size_t ChunkAt(float x, float z) const; // Fora do mapa, o chunk da borda mais próxima
+    size_t Size() const;                    // Slimes simulados em todos os chunks
+    size_t Population() const;              // Também os dos chunks virtuais
+    uint32_t Tick() const;
+
+    CreatureHandle Add(Slime_Type type, float x, float y, float z); // No chunk de (x, z), com o próximo id; CREATURE_HANDLE_NONE sem handles livres
+    // Swap-and-pop no pool do chunk; o slime movido para o lugar continua
+    // com o mesmo handle. Ignora handles de slimes que já saíram.
+    void Remove(CreatureHandle handle);
+    CreatureKey Find(CreatureHandle handle) const; // CREATURE_KEY_NONE se o slime já saiu
+    bool Contains(CreatureHandle handle) const;
+    glm::vec4 GetPosition(CreatureHandle handle) const; // O handle precisa ser válido
+
+    // Consultas às grades dos chunks que a região toca, como as de SpatialGrid,
+    // com os handles dos slimes encontrados
+    bool AnyInRadius(float x, float z, float radius) const;
+    size_t QueryAABB(glm::vec3 min, glm::vec3 max, std::vector<CreatureHandle>& out) const;
+    size_t QueryCone(const WeaponCone& cone, std::vector<CreatureHandle>& out) const;
+
+    void SaveRenderState();
+
+    // Registro das mudanças, para quem acompanha os slimes entre ticks (ver
+    // CreatureBroadPhase). Fica desligado até TrackChanges(), para não
+    // crescer sem ninguém ler; TakeChanges() entrega o que juntou e recomeça.
+    void TrackChanges();
+    bool TracksChanges() const;
+    void TakeChanges(CreatureChanges& out);
+
+    // CreaturePool::CatchUp() em todos os chunks simulados, seguido da troca
+    // de chunk. Os chunks virtuais não mudam: já são recolocados ao acaso.
+    void CatchUp(float seconds, float delta_t);
+
+    // População virtual. Um chunk simulado ainda pode ter contagem: os slimes
+    // que não couberam ao recolocá-lo, à espera de lugar
+    bool IsVirtual(size_t chunk) const;
+    uint32_t VirtualCount(size_t chunk) const;
+    float ChunkDistance(size_t chunk, float x, float z) const; // Do ponto até o bioma, no plano XZ
+    // Troca os slimes do chunk pela contagem por tipo, com a chave "key" para
+    // recolocá-los. Não recolhe (e retorna false) se algum está capturado.
+    bool Collapse(size_t chunk, uint32_t key);
+    // Um slime novo no chunk virtual; consome um id, como Add()
+    void AddVirtual(size_t chunk, Slime_Type type);
+    // Deixa o chunk simulado de novo, entregando a contagem e a chave guardadas
+    void TakeVirtual(size_t chunk, uint32_t count[SLIME_TYPE_COUNT], uint32_t& key);
+    // Devolve à contagem os slimes entregues por TakeVirtual() que não couberam
+    // no bioma; o chunk segue simulado e os ids já consumidos não mudam
+    void ReturnVirtual(size_t chunk, const uint32_t count[SLIME_TYPE_COUNT]);
+
+    // Um tick de todos os chunks, um por tarefa do JobSystem, seguido da troca
+    // de chunk de quem saiu do seu bioma. O pulo mais alto sai dos mais altos
+    // de cada chunk (em empate, o de menor chunk), com o handle do slime.
+    LoudestJump Update(JobSystem& jobs, float delta_t, glm::vec3 listener, float max_distance, const CreatureLod& lod, const CreatureFlock& flock);
+
+    uint64_t seed;
+    uint32_t next_id;
+
+private:
+    size_t Column(float x) const;
+    size_t Row(float z) const;
+    void FindLeaving(size_t chunk);
+    size_t Handoff();
+    // Aponta o slot do slime que o swap-and-pop de um Remove() moveu
+    void Moved(size_t chunk, size_t index);
+
+    struct ChunkBounds {
+        float min_x, max_x, min_z, max_z;
+    };
+
+    // Chunk sem slimes simulados, só com a conta por tipo
+    struct VirtualPopulation {
+        bool active;
+        uint32_t key;
+        uint32_t count[SLIME_TYPE_COUNT];
+    };
+
+    CreaturePool chunks[WORLD_CHUNK_COUNT];
+    ChunkBounds bounds[WORLD_CHUNK_COUNT]; // Bioma de cada chunk, [min, max)
+    VirtualPopulation virtuals[WORLD_CHUNK_COUNT];
+    CreatureScratch scratch[WORLD_CHUNK_COUNT];
+    std::vector<uint32_t> leaving[WORLD_CHUNK_COUNT]; // Slimes fora do bioma, em ordem crescente de índice
+    SlotMap<CreatureKey> slots; // Chave atual de cada handle vivo
+    bool tracking;
+    CreatureChanges changes; // Os movimentos ficam nos pools até TakeChanges()
+    float map_width, map_length;
+    float tile_width, tile_length;
+};
+
+#endif // CREATURE_WORLD_HPP
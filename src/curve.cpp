@@ -1,17 +1,49 @@
 #include "curve.hpp"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <vector>
 #include <glm/gtc/noise.hpp> 
 
 bool inWeaponRange(glm::vec4 weapon_position, glm::vec4 weapon_direction, glm::vec4 slime_position, float range, float minAngle) 
 {
-    glm::vec4 direction = slime_position - weapon_position;
-    float distance = glm::length(direction);
-    if (distance > range) {
+    return InWeaponCone(MakeWeaponCone(weapon_position, weapon_direction, range, minAngle), slime_position);
+}
+
+WeaponCone MakeWeaponCone(glm::vec4 weapon_position, glm::vec4 weapon_direction, float range, float minAngle) {
+    WeaponCone cone;
+    cone.apex = glm::vec3(weapon_position);
+    cone.direction = glm::normalize(glm::vec3(weapon_direction));
+    cone.range_squared = range * range;
+    float angle = glm::radians(minAngle);
+    cone.cos_angle = std::cos(angle);
+    // Em cada eixo, o setor vai até range se o eixo estiver dentro do cone;
+    // senão, até a direção do cone mais próxima do eixo
+    for (int axis = 0; axis < 3; axis++) {
+        float to_axis = std::acos(glm::clamp(cone.direction[axis], -1.0f, 1.0f));
+        float to_opposite = glm::pi<float>() - to_axis;
+        float reach_max = to_axis <= angle ? 1.0f : std::cos(to_axis - angle);
+        float reach_min = to_opposite <= angle ? 1.0f : std::cos(to_opposite - angle);
+        cone.box_max[axis] = cone.apex[axis] + range * std::max(reach_max, 0.0f);
+        cone.box_min[axis] = cone.apex[axis] - range * std::max(reach_min, 0.0f);
+    }
+    return cone;
+}
+
+// angle < minAngle vira dot > cos·|v|; elevando ao quadrado, |v| some, mas
+// o sinal de dot precisa ser olhado à parte. O próprio ápice fica de fora
+bool InWeaponCone(const WeaponCone& cone, glm::vec4 slime_position) {
+    glm::vec3 direction = glm::vec3(slime_position) - cone.apex;
+    float distance_squared = glm::dot(direction, direction);
+    if (distance_squared > cone.range_squared) {
         return false;
     }
-    float angle = glm::angle(glm::normalize(direction), weapon_direction);
-    return angle < glm::radians(minAngle);
+    float along = glm::dot(direction, cone.direction);
+    float threshold = cone.cos_angle * cone.cos_angle * distance_squared;
+    if (cone.cos_angle >= 0.0f) {
+        return along > 0.0f && along * along > threshold;
+    }
+    return along > 0.0f || along * along < threshold;
 }
 
 glm::vec3 cubicBezierCurve(const glm::vec3& P0, const glm::vec3& P1, const glm::vec3& P2, const glm::vec3& P3, float t) {
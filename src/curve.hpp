@@ -1,11 +1,32 @@
+#ifndef CURVE_HPP
+#define CURVE_HPP
+
 #include <glm/gtc/constants.hpp>
 #include <glm/gtx/rotate_vector.hpp>
 #include <glm/gtx/vector_angle.hpp>
 
 bool inWeaponRange(glm::vec4 weapon_position, glm::vec4 weapon_direction, glm::vec4 slime_position, float range, float minAngle);
 
+// Cone da arma pronto para testar muitos slimes: o cosseno do ângulo e a
+// caixa que contém o cone são calculados uma vez em MakeWeaponCone(), e
+// InWeaponCone() faz o teste de inWeaponRange() só com produtos escalares,
+// sem raiz nem acos por slime
+struct WeaponCone {
+    glm::vec3 apex;
+    glm::vec3 direction; // Normalizada
+    float range_squared;
+    float cos_angle;
+    glm::vec3 box_min;   // Caixa do setor esférico (distância até range, ângulo até angle)
+    glm::vec3 box_max;
+};
+
+WeaponCone MakeWeaponCone(glm::vec4 weapon_position, glm::vec4 weapon_direction, float range, float minAngle);
+bool InWeaponCone(const WeaponCone& cone, glm::vec4 slime_position);
+
 glm::vec3 cubicBezierCurve(const glm::vec3& P0, const glm::vec3& P1, const glm::vec3& P2, const glm::vec3& P3, float t);
 
 float randomOffset(int seed, float t);
 
-glm::vec3 bezierSpiralPosition(const glm::vec3& start, const glm::vec3& end, float t, int numSegments, float GROUND_LEVEL);
\ No newline at end of file
+glm::vec3 bezierSpiralPosition(const glm::vec3& start, const glm::vec3& end, float t, int numSegments, float GROUND_LEVEL);
+
+#endif // CURVE_HPP
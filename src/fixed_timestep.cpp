@@ -0,0 +1,38 @@
+#include "fixed_timestep.hpp"
+#include <cmath>
+
+FixedTimestep::FixedTimestep(float tick_rate, int max_steps) : step(1.0f / tick_rate), accumulator(0.0f), max_steps(max_steps) {
+}
+
+int FixedTimestep::Advance(float frame_time) {
+    if (frame_time > 0.0f) {
+        accumulator += frame_time;
+    }
+    int steps = (int)std::floor(accumulator / step);
+    if (steps > max_steps) {
+        steps = max_steps;
+    }
+    accumulator -= steps * step;
+    //Descarta o atraso que passou do limite, mantendo só a fração do tick
+    if (accumulator >= step) {
+        accumulator = std::fmod(accumulator, step);
+    }
+    return steps;
+}
+
+float FixedTimestep::Step() const {
+    return step;
+}
+
+float FixedTimestep::Alpha() const {
+    return accumulator / step;
+}
+
+void FixedTimestep::SetTickRate(float tick_rate) {
+    step = 1.0f / tick_rate;
+    Reset();
+}
+
+void FixedTimestep::Reset() {
+    accumulator = 0.0f;
+}
@@ -0,0 +1,28 @@
+#ifndef FIXED_TIMESTEP_HPP
+#define FIXED_TIMESTEP_HPP
+
+#define SIM_TICK_RATE 60.0f       // Ticks de simulação por segundo
+#define SIM_MAX_CATCHUP_STEPS 5   // Máximo de ticks simulados em um único quadro
+
+// Acumula o tempo real de cada quadro e informa quantos ticks de duração fixa
+// a simulação deve avançar. O tempo que sobra (menor que um tick) vira o fator
+// de interpolação usado no desenho. Se o quadro demorar demais, no máximo
+// max_steps ticks são simulados e o atraso restante é descartado.
+class FixedTimestep {
+public:
+    explicit FixedTimestep(float tick_rate = SIM_TICK_RATE, int max_steps = SIM_MAX_CATCHUP_STEPS);
+
+    int Advance(float frame_time); //Retorna o número de ticks a simular neste quadro
+    float Step() const;            //Duração de um tick em segundos
+    float Alpha() const;           //Fração do próximo tick já decorrida, em [0, 1)
+
+    void SetTickRate(float tick_rate);
+    void Reset();
+
+private:
+    float step;
+    float accumulator;
+    int max_steps;
+};
+
+#endif // FIXED_TIMESTEP_HPP
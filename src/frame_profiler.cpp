@@ -0,0 +1,47 @@
+#include "frame_profiler.hpp"
+
+static const char* const SECTION_NAMES[PROFILE_SECTION_COUNT] = {
+    "update", "spawn", "collision", "separation", "suction", "draw", "frame"
+};
+
+FrameProfiler::FrameProfiler(const char* title, const char* unit) : frames(0), title(title), unit(unit) {
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        current[i] = total[i] = worst[i] = 0.0;
+    }
+}
+
+void FrameProfiler::Begin(ProfileSection section) {
+    started[section] = Clock::now();
+}
+
+void FrameProfiler::End(ProfileSection section) {
+    current[section] += std::chrono::duration<double>(Clock::now() - started[section]).count();
+}
+
+void FrameProfiler::EndFrame() {
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        total[i] += current[i];
+        if (current[i] > worst[i]) {
+            worst[i] = current[i];
+        }
+        current[i] = 0.0;
+    }
+    frames++;
+}
+
+void FrameProfiler::Print(FILE* out, size_t slime_count) const {
+    fprintf(out, "%s profile: %zu %s, %zu slimes at exit\n", title, frames, unit, slime_count);
+    if (frames == 0) {
+        return;
+    }
+    double frame_average = total[PROFILE_FRAME] / frames;
+    fprintf(out, "%-10s %10s %10s %8s\n", "section", "avg ms", "max ms", "% frame");
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        double average = total[i] / frames;
+        double share = frame_average > 0.0 ? 100.0 * average / frame_average : 0.0;
+        fprintf(out, "%-10s %10.3f %10.3f %7.1f%%\n", SECTION_NAMES[i], average * 1000.0, worst[i] * 1000.0, share);
+    }
+    if (frame_average > 0.0) {
+        fprintf(out, "average %s per second: %.1f\n", unit, 1.0 / frame_average);
+    }
+}
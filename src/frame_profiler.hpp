@@ -0,0 +1,45 @@
+#ifndef FRAME_PROFILER_HPP
+#define FRAME_PROFILER_HPP
+
+#include <chrono>
+#include <cstdio>
+
+// Etapas do quadro medidas pelo FrameProfiler
+enum ProfileSection {
+    PROFILE_UPDATE,     // Física dos slimes
+    PROFILE_SPAWN,      // Nascimentos e demais comandos aplicados no fim do tick (WorldCommands)
+    PROFILE_COLLISION,  // Broad phase (sweep and prune) e narrow phase da câmera e da loja
+    PROFILE_SEPARATION, // Slimes sobrepostos afastados (CreatureSeparation)
+    PROFILE_SUCTION,    // Sucção e captura
+    PROFILE_DRAW,       // Montagem das instâncias e desenho dos slimes
+    PROFILE_FRAME,      // Quadro inteiro do estado GAME, com o glfwSwapBuffers (ou o tick inteiro, na thread da simulação)
+    PROFILE_SECTION_COUNT
+};
+
+// Soma o tempo gasto em cada etapa por quadro. Uma etapa pode ser medida
+// várias vezes no mesmo quadro (um por tick da simulação); EndFrame() fecha
+// o quadro e guarda média e máximo para Print().
+class FrameProfiler {
+public:
+    // "title" e "unit" só mudam o cabeçalho de Print(), como "Tick profile: 100 ticks"
+    explicit FrameProfiler(const char* title = "Frame", const char* unit = "frames");
+
+    void Begin(ProfileSection section);
+    void End(ProfileSection section);
+    void EndFrame();
+
+    void Print(FILE* out, size_t slime_count) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point started[PROFILE_SECTION_COUNT];
+    double current[PROFILE_SECTION_COUNT]; // Segundos no quadro atual
+    double total[PROFILE_SECTION_COUNT];
+    double worst[PROFILE_SECTION_COUNT];
+    size_t frames;
+    const char* title;
+    const char* unit;
+};
+
+#endif // FRAME_PROFILER_HPP
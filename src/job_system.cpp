@@ -0,0 +1,129 @@
+#include "job_system.hpp"
+#include <algorithm>
+
+JobSystem::JobSystem(unsigned int worker_count) : queued_tasks(0), stopping(false) {
+    // Uma fila por trabalhadora e mais uma para a thread que chama ParallelFor()
+    for (unsigned int i = 0; i <= worker_count; i++) {
+        workers.push_back(new Worker());
+    }
+    for (unsigned int i = 0; i < worker_count; i++) {
+        threads.push_back(std::thread(&JobSystem::WorkerLoop, this, (size_t)i));
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        delete workers[i];
+    }
+}
+
+unsigned int JobSystem::WorkerCount() const {
+    return (unsigned int)threads.size();
+}
+
+unsigned int JobSystem::DefaultWorkerCount() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 0;
+}
+
+size_t JobSystem::ChunkCount(size_t count, size_t grain) {
+    if (grain == 0) {
+        grain = 1;
+    }
+    return (count + grain - 1) / grain;
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grain, const RangeJob& job) {
+    if (count == 0) {
+        return;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+    size_t chunks = ChunkCount(count, grain);
+    if (threads.empty() || chunks == 1) {
+        for (size_t begin = 0; begin < count; begin += grain) {
+            job(begin, std::min(begin + grain, count));
+        }
+        return;
+    }
+
+    // Distribui os blocos em rodízio entre as filas
+    std::atomic<size_t> remaining(chunks);
+    for (size_t c = 0; c < chunks; c++) {
+        Task task = {&job, c * grain, std::min((c + 1) * grain, count), &remaining};
+        Worker* worker = workers[c % workers.size()];
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->tasks.push_back(task);
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        queued_tasks += chunks;
+    }
+    wake.notify_all();
+
+    // A thread chamadora ajuda até tudo terminar
+    size_t self = workers.size() - 1;
+    Task task;
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (PopOwn(self, task) || Steal(self, task)) {
+            Run(task);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool JobSystem::PopOwn(size_t index, Task& task) {
+    Worker* worker = workers[index];
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    if (worker->tasks.empty()) {
+        return false;
+    }
+    task = worker->tasks.back();
+    worker->tasks.pop_back();
+    queued_tasks--;
+    return true;
+}
+
+bool JobSystem::Steal(size_t thief, Task& task) {
+    for (size_t offset = 1; offset < workers.size(); offset++) {
+        Worker* victim = workers[(thief + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if (!victim->tasks.empty()) {
+            task = victim->tasks.front();
+            victim->tasks.pop_front();
+            queued_tasks--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::Run(const Task& task) {
+    (*task.job)(task.begin, task.end);
+    task.remaining->fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::WorkerLoop(size_t index) {
+    Task task;
+    while (true) {
+        if (PopOwn(index, task) || Steal(index, task)) {
+            Run(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake.wait(lock, [this] { return stopping || queued_tasks.load() > 0; });
+        if (stopping && queued_tasks.load() == 0) {
+            return;
+        }
+    }
+}
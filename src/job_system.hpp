@@ -0,0 +1,64 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Conjunto fixo de threads trabalhadoras. Cada uma tem sua própria fila
+// (deque): retira trabalho do fim da própria fila e, quando ela esvazia,
+// rouba do início da fila das outras. A thread que chama ParallelFor()
+// também executa tarefas enquanto espera. Duas threads podem chamar
+// ParallelFor() ao mesmo tempo (a simulação e o desenho): as duas usam a
+// fila extra e cada uma espera só pelas suas tarefas.
+class JobSystem {
+public:
+    typedef std::function<void(size_t begin, size_t end)> RangeJob;
+
+    explicit JobSystem(unsigned int worker_count = DefaultWorkerCount());
+    ~JobSystem();
+
+    unsigned int WorkerCount() const;
+
+    // Divide [0, count) em blocos de "grain" elementos e executa job(begin, end)
+    // para cada bloco. Retorna quando todos os blocos terminaram.
+    void ParallelFor(size_t count, size_t grain, const RangeJob& job);
+
+    static size_t ChunkCount(size_t count, size_t grain);
+    static unsigned int DefaultWorkerCount(); // Um a menos que o número de núcleos
+
+private:
+    struct Task {
+        const RangeJob* job;
+        size_t begin;
+        size_t end;
+        std::atomic<size_t>* remaining;
+    };
+
+    struct Worker {
+        std::deque<Task> tasks;
+        std::mutex mutex;
+    };
+
+    bool PopOwn(size_t worker, Task& task);
+    bool Steal(size_t thief, Task& task);
+    void Run(const Task& task);
+    void WorkerLoop(size_t worker);
+
+    std::vector<Worker*> workers; // A última fila pertence à thread que chama ParallelFor()
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queued_tasks;
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    JobSystem(const JobSystem&);
+    JobSystem& operator=(const JobSystem&);
+};
+
+#endif // JOB_SYSTEM_HPP
@@ -13,6 +13,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <algorithm>
+#include <mutex>
 
 // Headers das bibliotecas OpenGL
 #include <glad/glad.h>   // Criação de contexto OpenGL 3.3
@@ -34,8 +35,20 @@
 #include "matrices.h"
 #include "creature.hpp"
 #include "slime_types.hpp"
+#include "creature_pool.hpp"
+#include "creature_update.hpp"
+#include "creature_world.hpp"
+#include "world_commands.hpp"
+#include "creature_broad_phase.hpp"
+#include "creature_separation.hpp"
+#include "job_system.hpp"
+#include "sim_thread.hpp"
+#include "creature_render.hpp"
+#include "ranch_config.hpp"
+#include "frame_profiler.hpp"
 #include "curve.hpp"
 #include "collisions.hpp"
+#include "terrain.hpp"
 
 //Biblioteca para o uso de musica e efeitos sonoros
 #define MINIAUDIO_IMPLEMENTATION
@@ -44,9 +57,6 @@
 //Constantes
 #define window_width 1280
 #define window_height 720
-#define map_width 300.0f
-#define map_length 300.0f
-#define map_height 300.0f
 #define M_PI 3.141592653589793238462643383279502884L
 #define NORMAL_MODE true
 #define CHEAT_MODE false
@@ -118,10 +128,14 @@ void PopMatrix(glm::mat4& M);
 // Declaração de várias funções utilizadas em main().  Essas estão definidas
 // logo após a definição de main() neste arquivo.
 void BuildTrianglesAndAddToVirtualScene(ObjModel*); // Constrói representação de um ObjModel como malha de triângulos para renderização
+void BuildTerrainAndAddToVirtualScene(const Terrain& terrain); // Constrói a malha do chão de cada bioma, "terrain_0" a "terrain_8"
 void ComputeNormals(ObjModel* model); // Computa normais de um ObjModel, caso não existam.
 void LoadShadersFromFiles(); // Carrega os shaders de vértice e fragmento, criando um programa de GPU
 void LoadTextureImage(const char* filename); // Função que carrega imagens de textura
 void DrawVirtualObject(const char* object_name); // Desenha um objeto armazenado em g_VirtualScene
+void EnableInstancedAttributes(const char* object_name); // Liga g_InstanceBufferId ao VAO do objeto
+void UploadInstanceMatrices(const std::vector<glm::mat4>& matrices); // Envia as matrizes por instância para a GPU
+void DrawVirtualObjectInstanced(const char* object_name, GLsizei instance_count); // Desenha várias cópias do objeto
 GLuint LoadShader_Vertex(const char* filename);   // Carrega um vertex shader
 GLuint LoadShader_Fragment(const char* filename); // Carrega um fragment shader
 void LoadShader(const char* filename, GLuint shader_id); // Função utilizada pelas duas acima
@@ -154,6 +168,11 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 void CursorPosCallback(GLFWwindow* window, double xpos, double ypos);
 void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 void data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
+
+// Preço de cada nível de um upgrade, por tipo de slime, tirado de SLIME_TRAITS
+std::map<Slime_Type, std::vector<int>> UpgradeCostTable(Upgrade upgrade);
+// Posição da arma na mão do jogador, a partir da câmera
+glm::vec4 WeaponPosition(glm::vec4 camera_position, glm::vec4 camera_view_vector, glm::vec4 camera_up_vector);
 // Definimos uma estrutura que armazenará dados necessários para renderizar
 // cada objeto da cena virtual.
 struct SceneObject
@@ -227,6 +246,10 @@ GLint g_object_id_uniform;
 GLint g_bbox_min_uniform;
 GLint g_bbox_max_uniform;
 GLuint tilingLocation;
+GLint g_instanced_uniform;
+
+// Buffer com uma matriz de modelo por instância, usado no desenho dos slimes
+GLuint g_InstanceBufferId = 0;
 
 // Número de texturas carregadas pela função LoadTextureImage()
 GLuint g_NumLoadedTextures = 0;
@@ -256,17 +279,50 @@ const float NORMAL_SPEED = 5.0f;
 const float SPRINT_BONUS = 5.0f;
 
 
-float g_CameraVerticalVelocity = 0.0f;
+float g_CameraVerticalVelocity = 0.0f; // Só a thread da simulação mexe nesta e em g_IsJumping
 
 bool g_IsSprinting = false;
 bool g_IsJumping = false;
-bool g_Player_Started_Jumping = false;
+bool g_Player_Started_Jumping = false; // Espaço apertado desde o último quadro
 
 //Referente a cada tela do jogo
 enum GameState{GAME, MAIN_MENU, WIN, UPGRADE};
 
+// Teclas e câmera do quadro, copiadas para a thread da simulação
+struct PlayerInput
+{
+    bool forward, back, left, right;
+    bool sprint;
+    bool jump;    // Pedido de pulo ainda não lido por um tick
+    bool suction; // Botão direito: arma ligada
+    glm::vec4 view_vector, up_vector;
+    glm::vec4 u_vector, w_vector;
+};
+
+// Estado publicado pela simulação no fim de cada lote de ticks (ver SnapshotBuffer)
+struct GameSnapshot
+{
+    CreatureSnapshot creatures;
+    glm::vec4 previous_camera_position, camera_position;
+    float alpha;  // Fração do próximo tick já decorrida na publicação
+    double time;  // glfwGetTime() da publicação
+    std::vector<Slime_Type> inventory;
+    float stamina;
+    uint32_t store_visits; // Muda quando o jogador chega à loja
+};
+
 int main(int argc, char* argv[])
 {
+    // Opções da linha de comando (modo de estresse, tamanho do mapa, etc.)
+    RanchConfig ranch = DefaultRanchConfig();
+    if (!ParseRanchArguments(argc, argv, ranch))
+    {
+        std::exit(EXIT_FAILURE);
+    }
+    const float map_width = ranch.map_size;
+    const float map_length = ranch.map_size;
+    const float map_height = ranch.map_size;
+
     // Inicializamos a biblioteca GLFW, utilizada para criar uma janela do
     // sistema operacional, onde poderemos renderizar com OpenGL.
     int success = glfwInit();
@@ -724,12 +780,22 @@ int main(int argc, char* argv[])
     ComputeNormals(&store_monster);
     BuildTrianglesAndAddToVirtualScene(&store_monster);
 
-    if ( argc > 1 )
+    if ( !ranch.model_path.empty() )
     {
-        ObjModel model(argv[1]);
+        ObjModel model(ranch.model_path.c_str());
         BuildTrianglesAndAddToVirtualScene(&model);
     }
 
+    // Os slimes são desenhados com instâncias: uma chamada por parte do modelo de cada tipo
+    glGenBuffers(1, &g_InstanceBufferId);
+    for (int type = 0; type < SLIME_TYPE_COUNT; type++)
+    {
+        for (int part = 0; part < SLIME_TRAITS[type].mesh.part_count; part++)
+        {
+            EnableInstancedAttributes(SLIME_TRAITS[type].mesh.parts[part]);
+        }
+    }
+
     // Inicializamos o código para renderização de texto.
     TextRendering_Init();
 
@@ -741,10 +807,43 @@ int main(int argc, char* argv[])
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
     
-    float prev_time = (float)glfwGetTime();
+    // Simulação e desenho trocam só a entrada do jogador e o estado publicado
+    SimulationThread sim(ranch.tick_rate, SIM_MAX_CATCHUP_STEPS, ranch.sim_thread);
+    SnapshotBuffer<GameSnapshot> snapshots;
+    std::mutex input_mutex;
+    PlayerInput shared_input = {};
+    glm::vec4 previous_camera_position = camera_position_c; // Câmera no tick anterior, para interpolar
+    uint32_t store_visits = 0, store_visits_seen = 0;
+    double left_game_time = 0.0; // glfwGetTime() da ida ao menu, para o progresso parado
+    bool sim_resume_pending = true; // Pausada fora do jogo (começo, menus, loja); a pausa pedida pela loja no tick fica até ela fechar
+    std::vector<Slime_Type> hud_inventory; // Cópia do inventário do último estado publicado
+
+    // Threads que dividem a atualização dos slimes com a thread de renderização
+    JobSystem jobs;
+
+    // Um chunk da simulação por bioma; a mesma seed gera sempre o mesmo rancho
+    // e o mesmo relevo
+    uint64_t seed = ranch.seed != 0 ? ranch.seed : time(0);
+    Terrain terrain;
+    terrain.Generate(seed, map_width, map_length, ranch.terrain_relief);
+    BuildTerrainAndAddToVirtualScene(terrain);
+    CreatureWorld world(seed);
+    world.SetMapSize(map_width, map_length);
+    world.SetTerrain(&terrain);
+    if (ranch.virtual_distance > 0.0f)
+    {
+        // Biomas longe do ponto de partida já nascem só como contagem
+        StreamVirtualChunks(world, camera_position_c.x, camera_position_c.z, ranch.virtual_distance, map_width, map_length);
+    }
+    int slime_count = (int)InitialCreatureSpawn(world, ranch.starting_slimes, map_width, map_length);
+    CreatureFlock flock = MakeCreatureFlock(ranch.flocking, map_width, map_length);
+    CreatureInstances creature_instances;
+    std::vector<CreatureHandle> nearby_creatures; // Resultado das consultas às grades, reaproveitado entre ticks
+    std::vector<CreatureHandle> captured_creatures; // Slimes sendo sugados, para soltá-los sem varrer o mundo
 
-    std::vector<Creature*> creatures = InitialCreatureSpawn(STARTING_SLIMES, map_width, map_length);
-    int slime_count = STARTING_SLIMES;
+    // Tempo gasto em cada etapa do quadro, impresso ao sair no modo de estresse
+    FrameProfiler profiler;
+    FrameProfiler sim_profiler("Tick", "ticks"); // Etapas medidas na thread da simulação
 
     //Conta do jogador
     std::map<Slime_Type, int> balance = {
@@ -761,68 +860,32 @@ int main(int argc, char* argv[])
     std::vector<Slime_Type> inventory = {};
 
     float stamina_counter = DEFAULT_STAMINA;
-    //Preços dos upgrades
+    //Preços dos upgrades, em slimes de cada tipo (ver SLIME_TRAITS)
     int movement_speed_level = 0;
-    std::map<Slime_Type, std::vector<int>> movement_speed_costs = {
-    {ANEMO, {0, 2, 5}},
-    {CRYO, {0, 0, 0}},
-    {DENDRO, {0, 0, 0}},
-    {PLASMA, {0, 0, 0}},
-    {FIRE, {0, 0, 0}},
-    {GEO, {0, 0, 0}},
-    {ELECTRO, {2, 3, 5}},
-    {WATER, {0, 0, 0}}
-    };
+    std::map<Slime_Type, std::vector<int>> movement_speed_costs = UpgradeCostTable(UPGRADE_MOVEMENT_SPEED);
 
     int stamina_level = 0;
-    std::map<Slime_Type, std::vector<int>> stamina_costs = {
-    {ANEMO, {0, 0, 0}},
-    {CRYO, {0, 0, 0}},
-    {DENDRO, {0, 0, 0}},
-    {PLASMA, {0, 0, 0}},
-    {FIRE, {2, 3, 5}},
-    {GEO, {0, 2, 5}},
-    {ELECTRO, {0, 0, 0}},
-    {WATER, {0, 0, 0}}
-    };
+    std::map<Slime_Type, std::vector<int>> stamina_costs = UpgradeCostTable(UPGRADE_STAMINA);
 
     int slime_spawn_rate_level = 0;
-    std::map<Slime_Type, std::vector<int>> slime_spawn_rate_costs = {
-    {ANEMO, {0, 0, 0}},
-    {CRYO, {0, 0, 0}},
-    {DENDRO, {0, 2, 5}},
-    {PLASMA, {2, 3, 5}},
-    {FIRE, {0, 0, 0}},
-    {GEO, {0, 0, 0}},
-    {ELECTRO, {0, 0, 0}},
-    {WATER, {0, 2, 5}}
-    };
+    std::map<Slime_Type, std::vector<int>> slime_spawn_rate_costs = UpgradeCostTable(UPGRADE_SPAWN_RATE);
 
     int inventory_level = 0;
-    std::map<Slime_Type, std::vector<int>> inventory_costs = {
-    {ANEMO, {0, 0, 0}},
-    {CRYO, {2, 3, 5}},
-    {DENDRO, {0, 0, 0}},
-    {PLASMA, {0, 0, 0}},
-    {FIRE, {0, 0, 0}},
-    {GEO, {0, 0, 0}},
-    {ELECTRO, {0, 0, 0}},
-    {WATER, {0, 2, 5}}
-    };
+    std::map<Slime_Type, std::vector<int>> inventory_costs = UpgradeCostTable(UPGRADE_INVENTORY);
 
     int lore_progress_level = 0;
-    std::map<Slime_Type, std::vector<int>> lore_progress_costs = {
-    {ANEMO, {1, 4, 10}},
-    {CRYO, {4, 6, 10}},
-    {DENDRO, {1, 4, 10}},
-    {PLASMA, {4, 6, 10}},
-    {FIRE, {4, 6, 10}},
-    {GEO, {1, 4, 10}},
-    {ELECTRO, {4, 6, 10}},
-    {WATER, {1, 5, 10}}
-    };
-
-    std::vector<std::pair<int, int>> potentialCollisions;
+    std::map<Slime_Type, std::vector<int>> lore_progress_costs = UpgradeCostTable(UPGRADE_LORE);
+
+    CollisionPairBuffer collision_pairs; // Pares da broad phase do tick; a memória fica entre ticks
+    const glm::vec3 storeMonsterPosition = glm::vec3(2.0f, 4.25f, -30.0f);
+    CreatureBroadPhase broad_phase; // Câmera, loja e slimes; os pares mudam só com o que se moveu
+    broad_phase.SetStore(ComputeAABB(storeMonsterPosition, glm::vec3(15.0f, 15.0f, 15.0f)));
+    BroadPhasePairs broad_pairs;
+    SphereBatch contact_spheres; // Slimes dos pares, testados em lote na narrow phase
+    std::vector<uint64_t> contact_hits;
+    std::vector<CreatureKey> contact_keys;
+    CreatureSeparation separation;
+    WorldCommands commands; // Mudanças no mundo gravadas durante o tick e aplicadas no fim dele
 
     static float slime_spawn_timer = 0.0f;
 
@@ -848,6 +911,438 @@ int main(int argc, char* argv[])
         return -1;
     }
 
+    //Slimes que nascem em mais "elapsed" segundos, no ritmo do upgrade ou em spawn_rate
+    //por segundo. No modo de estresse o limite vale para os slimes vivos, repondo os capturados
+    auto spawns_due = [&](float elapsed) -> int
+    {
+        slime_spawn_timer += elapsed;
+        float spawn_interval = ranch.spawn_rate > 0.0f ? 1.0f / ranch.spawn_rate
+                             : std::max((SLIME_SPAWN_TIME - float(slime_spawn_rate_level) * 2), 1.0f);
+        int due = std::min(int(slime_spawn_timer / spawn_interval), ranch.slime_limit - (ranch.stress ? (int)world.Population() : slime_count));
+        if (due <= 0) {
+            return 0;
+        }
+        slime_spawn_timer -= due * spawn_interval;
+        return due;
+    };
+
+    // Avança o rancho "seconds" segundos de uma vez, sem ticks: os nascimentos
+    // desse tempo e depois o passeio de todos (ver CreaturePool::CatchUp()).
+    // Só com a simulação parada.
+    auto catch_up = [&](float seconds)
+    {
+        slime_count += (int)SpawnCreatures(world, spawns_due(seconds), map_width, map_length);
+        world.CatchUp(seconds, sim.Step());
+    };
+
+    // Um tick da simulação: câmera, slimes, colisões e sucção. Roda na
+    // SimulationThread e só conversa com a thread do desenho pela entrada
+    // (shared_input) e pelo estado publicado (snapshots)
+    auto simulate_tick = [&](float delta_t) -> bool
+    {
+        sim_profiler.Begin(PROFILE_FRAME);
+        PlayerInput input;
+        {
+            std::lock_guard<std::mutex> lock(input_mutex);
+            input = shared_input;
+            shared_input.jump = false;
+        }
+        float stamina_total = DEFAULT_STAMINA + stamina_level * 3;
+        uint32_t store_visits_before = store_visits;
+
+        world.SaveRenderState();
+        previous_camera_position = camera_position_c;
+        //Calculo de stamina para correr
+        float speed = NORMAL_SPEED + float(movement_speed_level);
+        if(input.sprint)
+        {
+            if(stamina_counter > 0.0f)
+            {
+                stamina_counter -= delta_t;
+                speed += SPRINT_BONUS;
+            }
+            else
+            {
+                stamina_counter = 0.0f;
+            }
+        }
+        else
+        {
+            stamina_counter += delta_t + stamina_level * (delta_t/2);
+            if(stamina_counter > stamina_total)
+            {
+                stamina_counter = stamina_total;
+            }
+        }
+
+        //Atualizacao das criaturas e exibição do som mais alto baseado na proximidade com o jogador
+        // Atualiza os chunks em paralelo; o pulo mais alto sai de uma redução determinística
+        sim_profiler.Begin(PROFILE_UPDATE);
+        const float maxDistance = 50.0f; // Maximum distance to hear sound
+        CreatureLod lod = {ranch.lod_distance > 0.0f, glm::vec3(camera_position_c), ranch.lod_distance, (uint32_t)ranch.lod_buckets};
+        flock.vacuum = input.suction; // Slimes fogem da arma ligada
+        flock.vacuum_position = glm::vec3(camera_position_c);
+        LoudestJump loudest = world.Update(jobs, delta_t, glm::vec3(camera_position_c), maxDistance, lod, flock);
+        sim_profiler.End(PROFILE_UPDATE);
+
+        //Roda o som mais alto se tiver
+        if (loudest.handle != CREATURE_HANDLE_NONE) {
+            commands.PlaySound(&slime_jump_sound, loudest.volume);
+        }
+
+        //Biomas perto do jogador ganham slimes de verdade, os longe viram contagem
+        if (ranch.virtual_distance > 0.0f)
+        {
+            StreamVirtualChunks(world, camera_position_c.x, camera_position_c.z, ranch.virtual_distance, map_width, map_length);
+        }
+
+        //Geração de slimes
+        int spawn_due = spawns_due(delta_t);
+        if (spawn_due > 0) {
+            commands.Spawn((uint32_t)spawn_due);
+        }
+    
+        //Calculo da camera. O pulo pedido pela tecla de espaço começa no tick seguinte
+        if (input.jump && !g_IsJumping) {
+            g_IsJumping = true;
+            g_CameraVerticalVelocity = JUMP_VELOCITY;
+            commands.PlaySound(&jump_sound);
+        }
+        g_CameraVerticalVelocity += GRAVITY * delta_t;
+        camera_position_c.y += g_CameraVerticalVelocity * delta_t;
+
+        float camera_ground = GROUND_LEVEL + terrain.Height(camera_position_c.x, camera_position_c.z);
+        if (camera_position_c.y < camera_ground)
+        {
+            camera_position_c.y = camera_ground;
+            g_CameraVerticalVelocity = 0.0f; // reseta a velocidade vertical quando houver colisao com o chao
+            g_IsJumping = false;
+        }
+
+        // Atualizamos a posição da câmera utilizando as teclas W, A, S, D
+        // Ajustar w_vector para ignorar a componente verical (y)
+        glm::vec4 w_vector_flat = input.w_vector;
+        w_vector_flat.y = 0.0f;
+        w_vector_flat = w_vector_flat / norm(w_vector_flat);
+        bool playerMoved = false;
+        if (input.forward) {
+            camera_position_c += -w_vector_flat * speed * delta_t;
+            playerMoved = true;
+        }
+        if (input.back) {
+            camera_position_c += w_vector_flat  * speed * delta_t;
+            playerMoved = true;
+        }
+        if (input.left) {
+            camera_position_c += -input.u_vector * speed * delta_t;
+            playerMoved = true;
+        }
+        if (input.right) {
+            camera_position_c += input.u_vector * speed * delta_t;
+            playerMoved = true;
+        }
+
+        //Som de passo enquanto o jogador caminha e não pula
+        if (playerMoved && !g_IsJumping) {
+            //Volume e pitch variam se esta andando ou correndo
+            bool running = input.sprint && stamina_counter > 0;
+            commands.PlaySound(&step_sound, running ? 1.0f : 0.8f, running ? 1.5f : 1.0f);
+        }
+
+        glm::vec3 cubeCenter = glm::vec3(0.0f, 0.0f, 0.0f);
+        glm::vec3 cubeSize = glm::vec3(map_width, map_height, map_length);
+
+        AABB frontFace;
+        frontFace.min = cubeCenter + glm::vec3(-cubeSize.x, -cubeSize.y, cubeSize.z);
+        frontFace.max = cubeCenter + glm::vec3(cubeSize.x, cubeSize.y, cubeSize.z);
+
+        AABB backFace;
+        backFace.min = cubeCenter + glm::vec3(-cubeSize.x, -cubeSize.y, -cubeSize.z);
+        backFace.max = cubeCenter + glm::vec3(cubeSize.x, cubeSize.y, -cubeSize.z);
+
+        AABB leftFace;
+        leftFace.min = cubeCenter + glm::vec3(-cubeSize.x, -cubeSize.y, -cubeSize.z);
+        leftFace.max = cubeCenter + glm::vec3(-cubeSize.x, cubeSize.y, cubeSize.z);
+
+        AABB rightFace;
+    
+        rightFace.min = cubeCenter + glm::vec3(cubeSize.x, -cubeSize.y, -cubeSize.z);
+        rightFace.max = cubeCenter + glm::vec3(cubeSize.x, cubeSize.y, cubeSize.z);
+
+        sim_profiler.Begin(PROFILE_COLLISION);
+        AABB cameraAABB = ComputeAABB(glm::vec3(camera_position_c), glm::vec3(0.7f, 0.7f, 2.5f));
+
+        // Fase de colisao Broad Phase
+        collision_pairs.Clear();
+        if (CheckAABBOverlap(cameraAABB, frontFace)) collision_pairs.Add(PAIR_CAMERA_WALL, WALL_FRONT);
+        if (CheckAABBOverlap(cameraAABB, backFace)) collision_pairs.Add(PAIR_CAMERA_WALL, WALL_BACK);
+        if (CheckAABBOverlap(cameraAABB, leftFace)) collision_pairs.Add(PAIR_CAMERA_WALL, WALL_LEFT);
+        if (CheckAABBOverlap(cameraAABB, rightFace)) collision_pairs.Add(PAIR_CAMERA_WALL, WALL_RIGHT);
+
+        // Câmera, loja e slimes pelo sweep and prune, que reaproveita a ordem do tick anterior
+        broad_phase.SetCamera(cameraAABB);
+        broad_phase.Sync(world);
+        broad_phase.GetPairs(broad_pairs);
+        if (broad_pairs.camera_store) {
+            collision_pairs.Add(PAIR_CAMERA_STORE, 0); // Colisao com o Store Monster
+        }
+        for (CreatureHandle handle : broad_pairs.camera_slimes) {
+            collision_pairs.Add(PAIR_CAMERA_SLIME, handle);
+        }
+
+        // Slimes não atravessam o Store Monster: saem pela lateral do cilindro
+        contact_spheres.Clear();
+        contact_keys.clear();
+        for (CreatureHandle handle : broad_pairs.store_slimes) {
+            CreatureKey key = world.Find(handle);
+            const CreaturePool& creatures = world.Chunk(CreatureKeyChunk(key));
+            if (!creatures.captured[CreatureKeyIndex(key)]) {
+                contact_spheres.Add(glm::vec3(creatures.GetPosition(CreatureKeyIndex(key))), 0.3f);
+                contact_keys.push_back(key);
+            }
+        }
+        CylinderSphereCollisionBatch(storeMonsterPosition, 4.0f, 15.0f, contact_spheres, contact_hits);
+        for (size_t k = 0; k < contact_keys.size(); k++) {
+            if (!BatchHit(contact_hits, k)) {
+                continue;
+            }
+            CreaturePool& creatures = world.Chunk(CreatureKeyChunk(contact_keys[k]));
+            size_t i = CreatureKeyIndex(contact_keys[k]);
+            glm::vec4 position = creatures.GetPosition(i);
+            glm::vec2 away = glm::vec2(position.x - storeMonsterPosition.x, position.z - storeMonsterPosition.z);
+            float magnitude = glm::length(away);
+            away = magnitude > 1e-5f ? away / magnitude : glm::vec2(1.0f, 0.0f);
+            away = glm::vec2(storeMonsterPosition.x, storeMonsterPosition.z) + away * (4.0f + 0.3f);
+            float height = creatures.is_jumping[i] ? position.y : creatures.GroundHeight(away.x, away.y);
+            creatures.SetPosition(i, glm::vec4(away.x, height, away.y, 1.0f));
+        }
+
+        sim_profiler.End(PROFILE_COLLISION);
+
+        // Slimes encostados uns nos outros se afastam
+        if (ranch.separation) {
+            sim_profiler.Begin(PROFILE_SEPARATION);
+            separation.Solve(jobs, world, broad_pairs.slime_slimes);
+            sim_profiler.End(PROFILE_SEPARATION);
+        }
+
+        sim_profiler.Begin(PROFILE_COLLISION);
+        // Fase de colisao Narrow Phase. Os slimes perto da câmera são testados
+        // juntos antes, contra a posição da câmera no começo da fase
+        contact_spheres.Clear();
+        for (const CollisionPair& pair : collision_pairs) {
+            if (pair.kind == PAIR_CAMERA_SLIME) {
+                contact_spheres.Add(glm::vec3(world.GetPosition(pair.id)), 0.6f);
+            }
+        }
+        SphereSphereOverlapBatch(glm::vec3(camera_position_c), 0.6f, contact_spheres, contact_hits);
+        size_t contact = 0;
+        bool touching_store = false;
+        for (const CollisionPair& pair : collision_pairs) {
+            if (pair.kind == PAIR_CAMERA_SLIME) { // Colisão entre a camera e um slime
+                CreatureHandle creatureHandle = pair.id;
+                if (BatchHit(contact_hits, contact++)) {
+                    glm::vec4 direction = camera_position_c - world.GetPosition(creatureHandle);
+                    float magnitude = glm::length(direction);
+                    if (magnitude > 1e-5f) {
+                        direction = glm::normalize(direction);
+                    }
+                    camera_position_c += direction * speed * delta_t * 0.05f;
+                }
+            } else if(pair.kind == PAIR_CAMERA_WALL) { //Colisao com as paredes da skybox
+                glm::vec3 faceCenter, faceNormal;
+                switch (pair.id) {
+                case WALL_FRONT: //Frente
+                    faceNormal = glm::vec3(0.0f, 0.0f, 1.0f);
+                    faceCenter = glm::vec3(0.0f, 0.0f, cubeSize.z);
+                    break;
+                case WALL_BACK: // Tras
+                    faceNormal = glm::vec3(0.0f, 0.0f, -1.0f);
+                    faceCenter = glm::vec3(0.0f, 0.0f, -cubeSize.z);
+                    break;
+                case WALL_LEFT: // Esquerda
+                    faceNormal = glm::vec3(-1.0f, 0.0f, 0.0f);
+                    faceCenter = glm::vec3(-cubeSize.x, 0.0f, 0.0f);
+                    break;
+                case WALL_RIGHT: // Direita
+                    faceNormal = glm::vec3(1.0f, 0.0f, 0.0f);
+                    faceCenter = glm::vec3(cubeSize.x, 0.0f, 0.0f);
+                    break;
+                default:
+                    continue;
+                }
+                faceNormal *= -1.0f; // Inverte a normal pro ponto ficar dentro da parede
+                float planeOffset = glm::dot(faceNormal, faceCenter);
+                if (SpherePlaneCollision(camera_position_c, 0.6f, faceNormal, planeOffset))             
+                {   //Colisao com ajuste adicional para suavizar a força contraria
+                    glm::vec3 cameraPosition3D = glm::vec3(camera_position_c);
+                    float distToPlane = glm::dot(faceNormal, cameraPosition3D) - planeOffset;
+                    if (distToPlane < 0.6f) {
+
+                        commands.PlaySound(&forcefield_sound, 3.0f);
+                        float correctionDistance = 0.6f - distToPlane;
+                        glm::vec3 correction = faceNormal * correctionDistance;
+                        camera_position_c += glm::vec4(correction, 0.0f);
+                        glm::vec3 velocityDirection = glm::vec3(-w_vector_flat * speed);
+                        float velocityIntoPlane = glm::dot(velocityDirection, faceNormal);
+                        if (velocityIntoPlane > 0) {
+                            glm::vec3 newVelocity = velocityDirection - (faceNormal * velocityIntoPlane);
+                            camera_position_c -= glm::vec4(newVelocity * delta_t, 0.0f);
+                        }
+
+                    }
+                
+                }
+            } else if (pair.kind == PAIR_CAMERA_STORE) { //Colisao com o store monster
+                touching_store = CylinderSphereCollision(storeMonsterPosition, 4.0f, 15.0f, glm::vec3(camera_position_c), 0.3f);
+            }
+        }
+
+        // Encostar no store monster abre a loja, uma vez até o jogador se afastar
+        if (touching_store && !seeing_store) {
+            commands.PlaySound(&welcome_sound);
+            commands.DepositInventory();
+            store_visits++; // O quadro seguinte abre a tela de upgrades
+        }
+        seeing_store = touching_store;
+
+
+        sim_profiler.End(PROFILE_COLLISION);
+
+        //Arma na posição simulada da câmera, usada pela sucção
+        glm::vec4 weapon_position = WeaponPosition(camera_position_c, input.view_vector, input.up_vector);
+        glm::vec4 weapon_direction = normalize(input.view_vector);
+
+        //Logica de sucção dos slimes e coleta
+        sim_profiler.Begin(PROFILE_SUCTION);
+        int inventory_size = store_visits != store_visits_before ? 0 : inventory.size(); // O depósito na loja só esvazia o inventário no fim do tick
+        const float suction_range = 7.0f, suction_angle = 35.0f;
+        const float captured_range = suction_range + 50.0f, captured_angle = suction_angle + 10.0f; // Slime já capturado escapa com mais dificuldade
+        if (input.suction && world.Size() > 0)
+        {
+            commands.PlaySound(&suction_sound);
+        }
+
+        // Cones da arma calculados uma vez por tick; o da sucção decide quem
+        // começa a ser capturado, o maior decide quem continua
+        WeaponCone suction_cone = MakeWeaponCone(weapon_position, weapon_direction, suction_range, suction_angle);
+        WeaponCone captured_cone = MakeWeaponCone(weapon_position, weapon_direction, captured_range, captured_angle);
+
+        // Solta os slimes capturados que saíram do cone, ou todos se o botão foi solto.
+        // Só percorre a lista dos capturados, não a população inteira
+        size_t still_captured = 0;
+        for (CreatureHandle handle : captured_creatures)
+        {
+            CreatureKey key = world.Find(handle);
+            if (key == CREATURE_KEY_NONE)
+            {
+                continue; // Já foi para o inventário
+            }
+            CreaturePool& creatures = world.Chunk(CreatureKeyChunk(key));
+            size_t i = CreatureKeyIndex(key);
+            if (!creatures.captured[i])
+            {
+                continue;
+            }
+            if (!(input.suction && InWeaponCone(captured_cone, creatures.GetPosition(i))))
+            {
+                creatures.captured[i] = false; // Finaliza a captura
+                creatures.SetPosition(i, glm::vec4(creatures.last_position_x[i], creatures.last_position_y[i], creatures.last_position_z[i], 1.0f));  // Define a posição final quando o botão é solto
+                continue;
+            }
+            captured_creatures[still_captured++] = handle;
+        }
+        captured_creatures.resize(still_captured);
+
+        // Puxa os slimes no cone da arma. As grades devolvem os que estão no cone
+        // maior (o dos já capturados); cada handle é procurado de novo, então
+        // o swap-and-pop de uma captura não troca o slime dos seguintes
+        if (input.suction)
+        {
+            nearby_creatures.clear();
+            world.QueryCone(captured_cone, nearby_creatures);
+            for (CreatureHandle handle : nearby_creatures)
+            {
+                CreatureKey key = world.Find(handle);
+                CreaturePool& creatures = world.Chunk(CreatureKeyChunk(key));
+                size_t i = CreatureKeyIndex(key);
+                glm::vec4 position = creatures.GetPosition(i);
+                if (!creatures.captured[i])
+                {
+                    if (!InWeaponCone(suction_cone, position))
+                    {
+                        continue;
+                    }
+                    // Inicia a captura se ainda não estiver capturada
+                    creatures.captured[i] = true;
+                    captured_creatures.push_back(handle);
+                    creatures.Wake(i);
+                    creatures.capture_time[i] = 0.0f;  // Resetando o tempo de captura
+                }
+
+                creatures.capture_time[i] += delta_t / 2.0f; // Ajuste a taxa de incremento de tempo
+                creatures.capture_time[i] = glm::clamp(creatures.capture_time[i], 0.0f, 1.0f); // Normaliza entre 0 e 1
+
+                glm::vec3 start = glm::vec3(position);
+                glm::vec3 end = glm::vec3(weapon_position);
+                glm::vec3 newPosition = bezierSpiralPosition(start, end, creatures.capture_time[i], 10, creatures.GroundHeight(start.x, start.z));
+                position = glm::vec4(newPosition, 1.0f);
+
+                if (creatures.capture_time[i] >= 1.0f) 
+                {//Indica que foi capturado
+                    if (inventory_size < DEFAULT_INVENTORY_SIZE + inventory_level)
+                    {
+                        commands.PlaySound(&pickup_sound);
+                        commands.AddToInventory(creatures.GetType(i));
+                        inventory_size++; // Conta os itens que ainda vão entrar
+                    }
+                    else //Mata ele caso o inventario esteja cheio
+                    {
+                        commands.PlaySound(&kill_sound);
+                    }
+                    commands.Despawn(handle); // Sai no fim do tick; o handle não aparece de novo neste laço
+                    continue;
+                }
+
+                // Atualiza a posição final durante o movimento
+                creatures.last_position_x[i] = position.x;
+                creatures.last_position_y[i] = position.y;
+                creatures.last_position_z[i] = position.z;
+            }
+        }
+        sim_profiler.End(PROFILE_SUCTION);
+
+        //Ponto de sincronização: nascimentos, capturas, inventário e sons do tick
+        sim_profiler.Begin(PROFILE_SPAWN);
+        slime_count += (int)commands.Apply(world, map_width, map_length, inventory, balance);
+        sim_profiler.End(PROFILE_SPAWN);
+
+        sim_profiler.End(PROFILE_FRAME);
+        sim_profiler.EndFrame();
+        return store_visits == store_visits_before; // A loja pausa a simulação
+    };
+
+    // Cópia do estado para o desenho, no fim de cada lote de ticks
+    auto publish_snapshot = [&](float alpha)
+    {
+        GameSnapshot& snapshot = snapshots.Back();
+        CaptureCreatures(jobs, world, snapshot.creatures);
+        snapshot.previous_camera_position = previous_camera_position;
+        snapshot.camera_position = camera_position_c;
+        snapshot.alpha = alpha;
+        snapshot.time = glfwGetTime();
+        snapshot.inventory = inventory;
+        snapshot.stamina = stamina_counter;
+        snapshot.store_visits = store_visits;
+        snapshots.Publish(false);
+    };
+    if (ranch.catch_up > 0.0f)
+    {
+        catch_up(ranch.catch_up);
+    }
+    publish_snapshot(0.0f); // O primeiro quadro já tem o que desenhar
+    sim.Start(simulate_tick, publish_snapshot);
+
     // Ficamos em um loop infinito, renderizando, até que o usuário feche a janela
     while (!glfwWindowShouldClose(window))
     {   //Tecla E ativa ou desativa sombras
@@ -873,6 +1368,11 @@ int main(int argc, char* argv[])
                     if(current_game_state == GAME)
                     {
                         currentDecoder = &decoder_game;
+                        //O rancho seguiu enquanto o jogador estava no menu
+                        if (ranch.idle_progress && left_game_time > 0.0)
+                        {
+                            catch_up(float(glfwGetTime() - left_game_time));
+                        }
                     }
                     else if(current_game_state == WIN)
                     {
@@ -1351,6 +1851,7 @@ int main(int argc, char* argv[])
                     g_EsckeyPressed = false;
                     current_game_state = MAIN_MENU;
                     last_game_state = GAME;
+                    left_game_time = glfwGetTime();
                     currentDecoder = &decoder_menu;
                     ma_device_uninit(&device);
                     ma_decoder_seek_to_pcm_frame(currentDecoder, 0);
@@ -1366,6 +1867,7 @@ int main(int argc, char* argv[])
                         printf("Failed to start playback device.\n");
                     }
                 }
+                profiler.Begin(PROFILE_FRAME);
                 // Aqui executamos as operações de renderização
 
                 // Definimos a cor do "fundo" do framebuffer como branco.  Tal cor é
@@ -1407,123 +1909,50 @@ int main(int argc, char* argv[])
                 u_vector = u_vector / norm(u_vector);
                 w_vector = w_vector / norm(w_vector);
 
-                float current_time = (float)glfwGetTime();
-                float delta_t = current_time - prev_time;
-                slime_spawn_timer += delta_t;
-                prev_time = current_time;
-                //Calculo de stamina para correr
-                float stamina_total = DEFAULT_STAMINA + stamina_level * 3;
-                float speed = NORMAL_SPEED + float(movement_speed_level);
-                if(g_IsSprinting)
+                // A simulação avança em ticks de duração fixa na SimulationThread
+                // (ou aqui mesmo, em sim.Poll(), com --sim-thread 0). O desenho usa o
+                // último estado publicado e interpola slimes e câmera dentro do tick.
                 {
-                    if(stamina_counter > 0.0f)
-                    {
-                        stamina_counter -= delta_t;
-                        speed += SPRINT_BONUS;
-                    }
-                    else
-                    {
-                        stamina_counter = 0.0f;
-                    }
+                    std::lock_guard<std::mutex> lock(input_mutex);
+                    shared_input.forward = g_WkeyPressed;
+                    shared_input.back = g_SkeyPressed;
+                    shared_input.left = g_AkeyPressed;
+                    shared_input.right = g_DkeyPressed;
+                    shared_input.sprint = g_IsSprinting;
+                    shared_input.jump = shared_input.jump || g_Player_Started_Jumping;
+                    shared_input.suction = g_RightMouseButtonPressed;
+                    shared_input.view_vector = camera_view_vector;
+                    shared_input.up_vector = camera_up_vector;
+                    shared_input.u_vector = u_vector;
+                    shared_input.w_vector = w_vector;
                 }
-                else
+                g_Player_Started_Jumping = false;
+                if (sim_resume_pending)
                 {
-                    stamina_counter += delta_t + stamina_level * (delta_t/2);
-                    if(stamina_counter > stamina_total)
-                    {
-                        stamina_counter = stamina_total;
-                    }
-                }
-
-                //Atualizacao das criaturas e exibição do som mais alto baseado na proximidade com o jogador
-                bool started_jumping;
-                float maxVolume = 0.0f;
-                Creature* loudestCreature = nullptr;
-
-                // Loop through all creatures to update and find the loudest jump
-                for (auto& creature : creatures) {
-                    bool started_jumping = creature->Update(delta_t);
-                    if (started_jumping) {
-                        glm::vec3 playerPos = glm::vec3(camera_position_c);
-                        glm::vec3 slimePos = glm::vec3(creature->GetPosition());
-                        float distance = glm::distance(playerPos, slimePos);
-
-                        // Normalize distance to volume
-                        float maxDistance = 50.0f; // Maximum distance to hear sound
-                        float volume = 1.0f - glm::clamp(distance / maxDistance, 0.0f, 1.0f);
-
-                        // Track the loudest jump
-                        if (volume > maxVolume) {
-                            maxVolume = volume;
-                            loudestCreature = creature;
-                        }
-                    }
+                    sim.Resume();
+                    sim_resume_pending = false;
                 }
+                sim.Poll();
+                float stamina_total = DEFAULT_STAMINA + stamina_level * 3;
 
-                //Roda o som mais alto se tiver
-                if (loudestCreature != nullptr) {
-                    ma_sound_set_volume(&slime_jump_sound, maxVolume);
-                    ma_sound_start(&slime_jump_sound);
-                }
-
-                //Geração de slimes
-                if ((slime_spawn_timer >= std::max((SLIME_SPAWN_TIME - float(slime_spawn_rate_level) * 2), 1.0f)) && slime_count < SLIME_LIMIT) {
-                    slime_spawn_timer = 0.0f;
-                    Creature* new_slime = SpawnCreature(map_width, map_length, creatures);
-                    slime_count++;
-                    creatures.push_back(new_slime);
-                }
-                
-                //Calculo da camera
-                g_CameraVerticalVelocity += GRAVITY * delta_t;
-                camera_position_c.y += g_CameraVerticalVelocity * delta_t;
-
-                if (camera_position_c.y < GROUND_LEVEL)
+                const GameSnapshot& snapshot = snapshots.Lock();
+                float alpha = std::min(snapshot.alpha + float(glfwGetTime() - snapshot.time) / sim.Step(), 1.0f);
+                glm::vec4 render_camera_position = snapshot.previous_camera_position + (snapshot.camera_position - snapshot.previous_camera_position) * alpha;
+                profiler.Begin(PROFILE_DRAW);
+                BuildCreatureInstances(jobs, snapshot.creatures, alpha, shadowMatrix, show_shadows, creature_instances);
+                profiler.End(PROFILE_DRAW);
+                hud_inventory = snapshot.inventory;
+                float hud_stamina = snapshot.stamina;
+                if (snapshot.store_visits != store_visits_seen)
                 {
-                    camera_position_c.y = GROUND_LEVEL;
-                    g_CameraVerticalVelocity = 0.0f; // reseta a velocidade vertical quando houver colisao com o chao
-                    g_IsJumping = false;
+                    store_visits_seen = snapshot.store_visits;
+                    current_game_state = UPGRADE; // A simulação para no fim do quadro
                 }
+                snapshots.Unlock();
 
-                // Atualizamos a posição da câmera utilizando as teclas W, A, S, D
-                // Ajustar w_vector para ignorar a componente verical (y)
-                glm::vec4 w_vector_flat = w_vector;
-                w_vector_flat.y = 0.0f;
-                w_vector_flat = w_vector_flat / norm(w_vector_flat);
-                bool playerMoved = false;
-                if (g_WkeyPressed) {
-                    camera_position_c += -w_vector_flat * speed * delta_t;
-                    playerMoved = true;
-                }
-                if (g_SkeyPressed) {
-                    camera_position_c += w_vector_flat  * speed * delta_t;
-                    playerMoved = true;
-                }
-                if (g_AkeyPressed) {
-                    camera_position_c += -u_vector * speed * delta_t;
-                    playerMoved = true;
-                }
-                if (g_DkeyPressed) {
-                    camera_position_c += u_vector * speed * delta_t;
-                    playerMoved = true;
-                }
-
-                //Som de passo enquanto o jogador caminha e não pula
-                if (playerMoved && !g_IsJumping) {
-                    //Volume e pitch variam se esta andando ou correndo
-                    ma_sound_set_volume(&step_sound, g_IsSprinting && stamina_counter > 0 ? 1.0f : 0.8f);
-                    ma_sound_set_pitch(&step_sound, g_IsSprinting && stamina_counter > 0 ? 1.5f : 1.0f);
-                    ma_sound_start(&step_sound);
-                }
-                //Som do pulo
-                if (g_Player_Started_Jumping) {
-                    ma_sound_start(&jump_sound);
-                    g_Player_Started_Jumping = false;
-                }
-                
                 // Computamos a matriz "View" utilizando os parâmetros da câmera para
                 // definir o sistema de coordenadas da câmera.  Veja slides 2-14, 184-190 e 236-242 do documento Aula_08_Sistemas_de_Coordenadas.pdf.
-                glm::mat4 view = Matrix_Camera_View(camera_position_c, camera_view_vector, camera_up_vector);
+                glm::mat4 view = Matrix_Camera_View(render_camera_position, camera_view_vector, camera_up_vector);
 
                 // Agora computamos a matriz de Projeção.
                 glm::mat4 projection;
@@ -1531,7 +1960,7 @@ int main(int argc, char* argv[])
                 // Note que, no sistema de coordenadas da câmera, os planos near e far
                 // estão no sentido negativo! Veja slides 176-204 do documento Aula_09_Projecoes.pdf.
                 float nearplane = -0.1f;  // Posição do "near plane"
-                float farplane  = -1000.0f; // Posição do "far plane"
+                float farplane  = -std::max(1000.0f, 4.0f * map_width); // Posição do "far plane", cobre o mapa inteiro
 
                 if (g_UsePerspectiveProjection)
                 {
@@ -1562,24 +1991,25 @@ int main(int argc, char* argv[])
                 glUniformMatrix4fv(g_view_uniform       , 1 , GL_FALSE , glm::value_ptr(view));
                 glUniformMatrix4fv(g_projection_uniform , 1 , GL_FALSE , glm::value_ptr(projection));
 
-                #define CREATURE 3
                 #define CUBE     11
                 #define WEAPON   12
                 #define PRIMEIRO_PLANO 20
                 #define STORE_MONSTER 34
                 #define SHADOW_ID 100
-                // Desenhamos os plano do chão pra cada bioma
+                // Desenhamos o chão de cada bioma (3x3 biomas cobrindo o mapa). A malha
+                // já está nas coordenadas do mundo, só abaixo da altura dos slimes
+                float tile_width = 2.0f * map_width / 3.0f;
+                float tile_length = 2.0f * map_length / 3.0f;
+                model = Matrix_Translate(0.0f, -1.1f, 0.0f);
+                glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+                glUniform2f(tilingLocation, tile_width / 20.0f, tile_length / 20.0f);
                 for(int i = 0; i < 9; i++)
                 {
-                    model = Matrix_Translate(-200.0f + 200 * (i % 3),-1.1f,-200.0f + 200 * (i / 3))
-                        * Matrix_Scale(100, 1.0f, 100);
-                    glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                     glUniform1i(g_object_id_uniform, 20 + i);
-                    glUniform2f(tilingLocation, 10.0f, 10.0f);
-                    DrawVirtualObject("the_plane");
+                    DrawVirtualObject(("terrain_" + std::to_string(i)).c_str());
                 }
                 //Desenha a arma
-                glm::vec4 weapon_position = camera_position_c + 0.4f * normalize(camera_view_vector) - 0.25f * normalize(crossproduct(camera_up_vector, camera_view_vector)) - 0.1f * camera_up_vector;
+                glm::vec4 weapon_position = WeaponPosition(render_camera_position, camera_view_vector, camera_up_vector);
                 glm::vec4 weapon_direction = normalize(camera_view_vector);
                 glm::vec4 weapon_right = normalize(crossproduct(camera_up_vector, weapon_direction));
                 glm::vec4 weapon_up = normalize(crossproduct(weapon_direction, weapon_right));
@@ -1597,382 +2027,39 @@ int main(int argc, char* argv[])
                 glUniform1i(g_object_id_uniform, WEAPON);
                 glUniform2f(tilingLocation, 1.0f, 1.0f);
                 DrawVirtualObject("weapon");
-                
-                glm::vec3 cubeCenter = glm::vec3(0.0f, 0.0f, 0.0f);
-                glm::vec3 cubeSize = glm::vec3(map_width, map_height, map_length);
-
-                AABB frontFace;
-                frontFace.min = cubeCenter + glm::vec3(-cubeSize.x, -cubeSize.y, cubeSize.z);
-                frontFace.max = cubeCenter + glm::vec3(cubeSize.x, cubeSize.y, cubeSize.z);
-
-                AABB backFace;
-                backFace.min = cubeCenter + glm::vec3(-cubeSize.x, -cubeSize.y, -cubeSize.z);
-                backFace.max = cubeCenter + glm::vec3(cubeSize.x, cubeSize.y, -cubeSize.z);
-
-                AABB leftFace;
-                leftFace.min = cubeCenter + glm::vec3(-cubeSize.x, -cubeSize.y, -cubeSize.z);
-                leftFace.max = cubeCenter + glm::vec3(-cubeSize.x, cubeSize.y, cubeSize.z);
-
-                AABB rightFace;
-                
-                rightFace.min = cubeCenter + glm::vec3(cubeSize.x, -cubeSize.y, -cubeSize.z);
-                rightFace.max = cubeCenter + glm::vec3(cubeSize.x, cubeSize.y, cubeSize.z);
-
-                AABB cameraAABB = ComputeAABB(glm::vec3(camera_position_c), glm::vec3(0.7f, 0.7f, 2.5f));
-
-                // Fase de colisao Broad Phase
-                if (CheckAABBOverlap(cameraAABB, frontFace)) potentialCollisions.push_back({-2, 0});
-                if (CheckAABBOverlap(cameraAABB, backFace)) potentialCollisions.push_back({-2, 1});
-                if (CheckAABBOverlap(cameraAABB, leftFace)) potentialCollisions.push_back({-2, 2});
-                if (CheckAABBOverlap(cameraAABB, rightFace)) potentialCollisions.push_back({-2, 3});
-
-                // Colisao com o Store Monster
-                AABB storeMonsterAABB = ComputeAABB(glm::vec3(2.0f,4.25f,-30.0f), glm::vec3(15.0f, 15.0f, 15.0f));
-                if (CheckAABBOverlap(cameraAABB, storeMonsterAABB)) {
-                    potentialCollisions.push_back({-3, 1});
-                }
-                
-                for (size_t i = 0; i < creatures.size(); ++i) {
-                    AABB creatureAABB = ComputeAABB(creatures[i]->GetPosition(), glm::vec3(0.55f, 0.55f, 0.55f));
-                    if (CheckAABBOverlap(cameraAABB, creatureAABB)) {
-                        potentialCollisions.push_back({-1, i}); // -1 para identificar a camera
-                    }
-                }
-
-                // Fase de colisao Narrow Phase
-                for (const auto& pair : potentialCollisions) {
-                    if (pair.first == -1) { // Colisão entre a camera e um slime
-                        int creatureIndex = pair.second;
-                        if (CheckSphereSphereOverlap(camera_position_c, 0.6,
-                                            creatures[creatureIndex]->GetPosition(), 0.6)) {
-                            glm::vec4 direction = camera_position_c - creatures[creatureIndex]->GetPosition();
-                            float magnitude = glm::length(direction);
-                            if (magnitude > 1e-5f) {
-                                direction = glm::normalize(direction);
-                            }
-                            camera_position_c += direction * speed * delta_t * 0.05f;
-                        }
-                    } else if(pair.first == -2) { //Colisao com as paredes da skybox
-                        glm::vec3 faceCenter, faceNormal;
-                        if (pair.second == 0) { //Frente
-                            faceNormal = glm::vec3(0.0f, 0.0f, 1.0f);
-                            faceCenter = glm::vec3(0.0f, 0.0f, cubeSize.z);
-                        } else if (pair.second == 1) { // Tras
-                            faceNormal = glm::vec3(0.0f, 0.0f, -1.0f);
-                            faceCenter = glm::vec3(0.0f, 0.0f, -cubeSize.z);
-                        } else if (pair.second == 2) { // Esquerda
-                            faceNormal = glm::vec3(-1.0f, 0.0f, 0.0f);
-                            faceCenter = glm::vec3(-cubeSize.x, 0.0f, 0.0f);
-                        } else if (pair.second == 3) { // Direita
-                            faceNormal = glm::vec3(1.0f, 0.0f, 0.0f);
-                            faceCenter = glm::vec3(cubeSize.x, 0.0f, 0.0f);
-                        }        
-                        faceNormal *= -1.0f; // Inverte a normal pro ponto ficar dentro da parede
-                        float planeOffset = glm::dot(faceNormal, faceCenter);
-                        if (SpherePlaneCollision(camera_position_c, 0.6f, faceNormal, planeOffset))             
-                        {   //Colisao com ajuste adicional para suavizar a força contraria
-                            glm::vec3 cameraPosition3D = glm::vec3(camera_position_c);
-                            float distToPlane = glm::dot(faceNormal, cameraPosition3D) - planeOffset;
-                            if (distToPlane < 0.6f) {
-
-                                ma_sound_set_volume(&forcefield_sound, 3.0f);
-                                ma_sound_start(&forcefield_sound);
-                                float correctionDistance = 0.6f - distToPlane;
-                                glm::vec3 correction = faceNormal * correctionDistance;
-                                camera_position_c += glm::vec4(correction, 0.0f);
-                                glm::vec3 velocityDirection = glm::vec3(-w_vector_flat * speed);
-                                float velocityIntoPlane = glm::dot(velocityDirection, faceNormal);
-                                if (velocityIntoPlane > 0) {
-                                    glm::vec3 newVelocity = velocityDirection - (faceNormal * velocityIntoPlane);
-                                    camera_position_c -= glm::vec4(newVelocity * delta_t, 0.0f);
-                                }
-
-                            }
-                            
-                        }
-                    potentialCollisions.erase(std::remove(potentialCollisions.begin(), potentialCollisions.end(), pair), potentialCollisions.end());
-                    } else if (pair.first == -3) { //Colisao com o store monster, que abre a loja
-                        if (CylinderSphereCollision(glm::vec3(2.0f, 4.25f, -30.0f), 4.0f, 15.0f, glm::vec3(camera_position_c), 0.3f)) {
-                            if (!seeing_store) {
-                                glm::vec3 direction = glm::vec3(2.0f, 4.25f, -30.0f) - glm::vec3(camera_position_c);
-                                float magnitude = glm::length(direction);
-                                if (magnitude > 1e-5f) {
-                                    direction = glm::normalize(direction);
-                                }
-                                
-                                ma_sound_start(&welcome_sound);
-
-                                for (const auto& slime : inventory)
-                                {
-                                    balance[slime]++;
-                                }
-                                inventory.clear();
-                                current_game_state = UPGRADE;
-                                seeing_store = true;
-                            }
-                            
-                        } else if (seeing_store) {
-                            seeing_store = false;
-                        }
-                    }
-                }
 
-                //Logica de sucção dos slimes e coleta
-                int inventory_size = inventory.size();
-                for (auto it = creatures.begin(); it != creatures.end(); ++it) 
+                //Desenho dos slimes e suas sombras, interpolados entre os dois últimos ticks.
+                //Cada parte do modelo de cada tipo é desenhada uma vez, com todas as instâncias
+                profiler.Begin(PROFILE_DRAW);
+                glUniform1i(g_instanced_uniform, 1);
+                glUniform2f(tilingLocation, 1.0f, 1.0f);
+                for (int creature_type = 0; creature_type < SLIME_TYPE_COUNT; creature_type++)
                 {
-                    auto& creature = *it;
-                    glm::vec4 position = creature->GetPosition();
-                    float rotation_angle = creature->GetRotationAngle();
-
-                    if (g_RightMouseButtonPressed) 
-                    {   
-                        float range_bonus = 0.0f, angle_bonus = 0.0f;
-                        ma_sound_start(&suction_sound);
-                        if(creature->captured)
-                        {
-                            range_bonus = 50.0f;
-                            angle_bonus = 10.0f;
-                        }
-
-                        if (inWeaponRange(weapon_position, weapon_direction, position, 7.0f + range_bonus, 35.0f + angle_bonus)) 
-                        {
-                            if (!creature->captured) 
-                            {  // Inicia a captura se ainda não estiver capturada
-                                creature->captured = true;
-                                creature->capture_time = 0.0f;  // Resetando o tempo de captura
-                            }
-
-                            creature->capture_time += delta_t / 2.0f; // Ajuste a taxa de incremento de tempo
-                            creature->capture_time = glm::clamp(creature->capture_time, 0.0f, 1.0f); // Normaliza entre 0 e 1
-
-                            glm::vec3 start = glm::vec3(position);
-                            glm::vec3 end = glm::vec3(weapon_position);
-                            glm::vec3 newPosition = bezierSpiralPosition(start, end, creature->capture_time, 10, GROUND_LEVEL);
-                            position = glm::vec4(newPosition, 1.0f);
-
-                            if (creature->capture_time >= 1.0f) 
-                            {//Indica que foi capturado
-                                creature->capture_time = 0.0f;  // Resetando o tempo de captura
-                                position = glm::vec4(end, 1.0f); // Finaliza no centro da arma
-                                if (inventory_size < DEFAULT_INVENTORY_SIZE + inventory_level)
-                                {
-                                    ma_sound_start(&pickup_sound);
-                                    Slime_Type type = Slime_Type(creature->GetType());
-                                    inventory.push_back(type);
-                                }
-                                else //Mata ele caso o inventario esteja cheio
-                                {
-                                    ma_sound_start(&kill_sound);
-                                }
-                                it = creatures.erase(it);
-                                continue;
-                            }
-
-                            creature->lastPosition = position;  // Atualiza a posição final durante o movimento
-                        } 
-                        else 
-                        {
-                            if (creature->captured) 
-                            {
-                                creature->captured = false; // Finaliza a captura
-                                creature->setPosition(creature->lastPosition);  // Define a posição final quando o botão é solto
-                            } 
-                        }
-                    } 
-                    else 
+                    const SlimeMesh& mesh = SLIME_TRAITS[creature_type].mesh;
+                    GLsizei instance_count = (GLsizei)creature_instances.models[creature_type].size();
+                    if (instance_count == 0)
                     {
-                        // Se o botão do mouse foi solto e a criatura estava capturada
-                        if (creature->captured) 
-                        {
-                            creature->captured = false; // Finaliza a captura
-                            creature->setPosition(creature->lastPosition);  // Define a posição final quando o botão é solto
-                            position = creature->lastPosition;
-                        }
+                        continue;
                     }
-
-                    //Desenho de cada slime e sua sombra
-                    if (creature->GetType() == 0) { // Anemo
-                        model = Matrix_Translate(position.x, position.y - 1.5f, position.z) 
-                                    * Matrix_Rotate_Y(rotation_angle) 
-                                    * Matrix_Scale(1.0f, 1.0f, 1.0f);
-                        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-                        glUniform1i(g_object_id_uniform, creature->GetType() + CREATURE);
-                        glUniform2f(tilingLocation, 1.0f, 1.0f);
-                        DrawVirtualObject("anemo1");
-                        DrawVirtualObject("anemo2");
-                        DrawVirtualObject("anemo3");
-                        //Anemo Shadow
-                        if(show_shadows)
-                        {
-                            glm::mat4 shadowModel = Matrix_Translate(position.x, -1.0f, position.z) * shadowMatrix * Matrix_Rotate_Y(rotation_angle) ;
-                            glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(shadowModel));
-                            glUniform1i(g_object_id_uniform, SHADOW_ID);
-                            DrawVirtualObject("anemo1");
-                            DrawVirtualObject("anemo2");
-                            DrawVirtualObject("anemo3");
-                        }
-
-                    } else if (creature->GetType() == 1) { // Cryo
-                        model = Matrix_Translate(position.x, position.y - 1.5f, position.z) 
-                                    * Matrix_Rotate_Y(rotation_angle) 
-                                    * Matrix_Rotate_X(3*3.141592f/2.0f) 
-                                    * Matrix_Scale(1.0f, 1.0f, 1.0f);
-                        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-                        glUniform1i(g_object_id_uniform, creature->GetType() + CREATURE);
-                        glUniform2f(tilingLocation, 1.0f, 1.0f);
-                        DrawVirtualObject("cryo1");
-                        DrawVirtualObject("cryo2");
-                        //Cryo Shadow
-                        if(show_shadows)
-                        {
-                            glm::mat4 shadowModel = Matrix_Translate(position.x, -1.0f, position.z) * shadowMatrix * Matrix_Rotate_Y(rotation_angle)  * Matrix_Rotate_X(3*3.141592f/2.0f) ;
-                            glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(shadowModel));
-                            glUniform1i(g_object_id_uniform, SHADOW_ID);
-                            DrawVirtualObject("cryo1");
-                            DrawVirtualObject("cryo2");
-                        }
-                    } else if (creature->GetType() == 2) { // Dendro
-                        model = Matrix_Translate(position.x, position.y - 1.5f, position.z) 
-                                    * Matrix_Rotate_Y(rotation_angle) 
-                                    * Matrix_Rotate_X(3*3.141592f/2.0f)
-                                    * Matrix_Scale(1.0f, 1.0f, 1.0f);
-                        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-                        glUniform1i(g_object_id_uniform, creature->GetType() + CREATURE);
-                        glUniform2f(tilingLocation, 1.0f, 1.0f);
-                        DrawVirtualObject("dendro1");
-                        DrawVirtualObject("dendro2");
-                        DrawVirtualObject("dendro3");
-                        DrawVirtualObject("dendro4");
-                        DrawVirtualObject("dendro5");
-                        DrawVirtualObject("dendro6");
-                        DrawVirtualObject("dendro7");
-                        DrawVirtualObject("dendro8");
-                        DrawVirtualObject("dendro9");
-                        DrawVirtualObject("dendro10");
-                        DrawVirtualObject("dendro11");
-                        DrawVirtualObject("dendro12");
-                        DrawVirtualObject("dendro13");
-                        DrawVirtualObject("dendro14");
-                        DrawVirtualObject("dendro15");
-                        DrawVirtualObject("dendro16");
-                        //Dendro Shadow
-                        if(show_shadows)
-                        {
-                            glm::mat4 shadowModel = Matrix_Translate(position.x, -1.0f, position.z) * shadowMatrix * Matrix_Rotate_Y(rotation_angle) * Matrix_Rotate_X(3*3.141592f/2.0f);
-                            glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(shadowModel));
-                            glUniform1i(g_object_id_uniform, SHADOW_ID);
-                            DrawVirtualObject("dendro1");
-                            DrawVirtualObject("dendro2");
-                            DrawVirtualObject("dendro3");
-                            DrawVirtualObject("dendro4");
-                            DrawVirtualObject("dendro5");
-                            DrawVirtualObject("dendro6");
-                            DrawVirtualObject("dendro7");
-                            DrawVirtualObject("dendro8");
-                            DrawVirtualObject("dendro9");
-                            DrawVirtualObject("dendro10");
-                            DrawVirtualObject("dendro11");
-                            DrawVirtualObject("dendro12");
-                            DrawVirtualObject("dendro13");
-                            DrawVirtualObject("dendro14");
-                            DrawVirtualObject("dendro15");
-                            DrawVirtualObject("dendro16");
-                        }
-                    } else if (creature->GetType() == 3) { // Plasma
-                        model = Matrix_Translate(position.x, position.y - 1.5f, position.z) 
-                                    * Matrix_Rotate_Y(rotation_angle) 
-                                    * Matrix_Scale(0.01f, 0.01f, 0.01f);
-                        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-                        glUniform1i(g_object_id_uniform, creature->GetType() + CREATURE);
-                        glUniform2f(tilingLocation, 1.0f, 1.0f);
-                        DrawVirtualObject("plasma1");
-                        DrawVirtualObject("plasma2");
-                        DrawVirtualObject("plasma3");
-                        //Plasma Shadow
-                        if(show_shadows)
-                        {
-                            glm::mat4 shadowModel = Matrix_Translate(position.x, -1.0f, position.z) * shadowMatrix * Matrix_Rotate_Y(rotation_angle) * Matrix_Scale(0.01f, 0.01f, 0.01f);;
-                            glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(shadowModel));
-                            glUniform1i(g_object_id_uniform, SHADOW_ID);
-                            DrawVirtualObject("plasma1");
-                            DrawVirtualObject("plasma2");
-                            DrawVirtualObject("plasma3");
-                        }
-                    } else if (creature->GetType() == 4) { // Fire
-                        model = Matrix_Translate(position.x, position.y - 1.5f, position.z) 
-                                    * Matrix_Rotate_Y(rotation_angle) 
-                                    * Matrix_Scale(0.01f, 0.01f, 0.01f);
-                        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-                        glUniform1i(g_object_id_uniform, creature->GetType() + CREATURE);
-                        glUniform2f(tilingLocation, 1.0f, 1.0f); 
-                        DrawVirtualObject("fire1");
-                        DrawVirtualObject("fire2");
-                        //Fire Shadow
-                        if(show_shadows)
-                        {
-                            glm::mat4 shadowModel = Matrix_Translate(position.x, -1.0f, position.z) * shadowMatrix * Matrix_Rotate_Y(rotation_angle) * Matrix_Scale(0.01f, 0.01f, 0.01f);
-                            glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(shadowModel));
-                            glUniform1i(g_object_id_uniform, SHADOW_ID);
-                            DrawVirtualObject("fire1");
-                            DrawVirtualObject("fire2");
-                        }
-                    } else if (creature->GetType() == 5) { // Geo
-                        model = Matrix_Translate(position.x, position.y - 1.5f, position.z) 
-                                    * Matrix_Rotate_Y(rotation_angle) 
-                                    * Matrix_Scale(0.01f, 0.01f, 0.01f);
-                        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-                        glUniform1i(g_object_id_uniform, creature->GetType() + CREATURE);
-                        glUniform2f(tilingLocation, 1.0f, 1.0f);
-                        DrawVirtualObject("geo1");
-                        //Geo Shadow
-                        if(show_shadows)
-                        {
-                            glm::mat4 shadowModel = Matrix_Translate(position.x, -1.0f, position.z) * shadowMatrix * Matrix_Rotate_Y(rotation_angle) * Matrix_Scale(0.01f, 0.01f, 0.01f);
-                            glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(shadowModel));
-                            glUniform1i(g_object_id_uniform, SHADOW_ID);
-                            DrawVirtualObject("geo1");
-                        }
-                    } else if (creature->GetType() == 6) { //Electro
-                        model = Matrix_Translate(position.x, position.y - 1.5f, position.z)
-                                    * Matrix_Rotate_Y(rotation_angle)
-                                    * Matrix_Scale(0.01f, 0.01f, 0.01f);
-                        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-                        glUniform1i(g_object_id_uniform, creature->GetType() + CREATURE);
-                        glUniform2f(tilingLocation, 1.0f, 1.0f); 
-                        DrawVirtualObject("electro1");
-                        DrawVirtualObject("electro2");
-                        DrawVirtualObject("electro3");
-                        //Electro Shadow
-                        if(show_shadows)
-                        {
-                            glm::mat4 shadowModel = Matrix_Translate(position.x, -1.0f, position.z) * shadowMatrix * Matrix_Rotate_Y(rotation_angle) * Matrix_Scale(0.01f, 0.01f, 0.01f);
-                            glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(shadowModel));
-                            glUniform1i(g_object_id_uniform, SHADOW_ID);
-                            DrawVirtualObject("electro1");
-                            DrawVirtualObject("electro2");
-                            DrawVirtualObject("electro3");
-                        }
-                    } else if (creature->GetType() == 7) { // Water
-                        model = Matrix_Translate(position.x, position.y - 1.5f, position.z) 
-                                    * Matrix_Rotate_Y(rotation_angle) 
-                                    * Matrix_Scale(0.01f, 0.01f, 0.01f);
-                        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-                        glUniform1i(g_object_id_uniform, creature->GetType() + CREATURE);
-                        glUniform2f(tilingLocation, 1.0f, 1.0f);
-                        DrawVirtualObject("water1");
-                        DrawVirtualObject("water2");
-                        //Water Shadow
-                        if(show_shadows)
+                    UploadInstanceMatrices(creature_instances.models[creature_type]);
+                    glUniform1i(g_object_id_uniform, SLIME_TRAITS[creature_type].object_id);
+                    for (int part = 0; part < mesh.part_count; part++)
+                    {
+                        DrawVirtualObjectInstanced(mesh.parts[part], instance_count);
+                    }
+                    if(show_shadows)
+                    {
+                        UploadInstanceMatrices(creature_instances.shadows[creature_type]);
+                        glUniform1i(g_object_id_uniform, SHADOW_ID);
+                        for (int part = 0; part < mesh.part_count; part++)
                         {
-                            glm::mat4 shadowModel = Matrix_Translate(position.x, -1.0f, position.z) * shadowMatrix * Matrix_Rotate_Y(rotation_angle)  * Matrix_Scale(0.01f, 0.01f, 0.01f);
-                            glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(shadowModel));
-                            glUniform1i(g_object_id_uniform, SHADOW_ID);
-                            DrawVirtualObject("water1");
-                            DrawVirtualObject("water2");
+                            DrawVirtualObjectInstanced(mesh.parts[part], instance_count);
                         }
                     }
                 }
+                glUniform1i(g_instanced_uniform, 0);
+                profiler.End(PROFILE_DRAW);
+
                 //Store Monster
                 model = Matrix_Translate(2.0f,4.25f,-30.0f)
                         * Matrix_Scale(15.0f, 15.0f, 15.0f)
@@ -1992,13 +2079,14 @@ int main(int argc, char* argv[])
                 DrawVirtualObject("cube");
 
                 //Texto na tela
+                int inventory_size = hud_inventory.size();
                 std::string constructed_string = "Inventory: Capacity: " + std::to_string(DEFAULT_INVENTORY_SIZE + inventory_level) + ", Size: " + std::to_string(inventory_size) + ", Items: ";
-                for(const auto& slime : inventory) 
+                for(const auto& slime : hud_inventory) 
                 {
                     constructed_string += to_string(slime) + ", ";
                 }
                 TextRendering_PrintString(window, constructed_string, -0.99f, -0.95, 1.5f);
-                constructed_string = "Stamina: " + std::to_string(stamina_counter) + "/" + std::to_string(stamina_total);
+                constructed_string = "Stamina: " + std::to_string(hud_stamina) + "/" + std::to_string(stamina_total);
                 TextRendering_PrintString(window, constructed_string, -0.99f, 0.95, 1.5f);
 
                 // Imprimimos na tela informação sobre o número de quadros renderizados
@@ -2071,6 +2159,7 @@ int main(int argc, char* argv[])
                 }
                 else if(g_FivekeyPressed && mode == CHEAT_MODE)
                 {
+                    sim.Pause(); // O inventário é da simulação
                     ma_sound_start(&welcome_sound);
 
                     for (const auto& slime : inventory)
@@ -2091,6 +2180,8 @@ int main(int argc, char* argv[])
                 // Veja o link: https://en.wikipedia.org/w/index.php?title=Multiple_buffering&oldid=793452829#Double_buffering_in_computer_graphics
 
                 glfwSwapBuffers(window);
+                profiler.End(PROFILE_FRAME);
+                profiler.EndFrame();
 
                 // Verificamos com o sistema operacional se houve alguma interação do
                 // usuário (teclado, mouse, ...). Caso positivo, as funções de callback
@@ -2100,7 +2191,20 @@ int main(int argc, char* argv[])
                 break;
             }
         }
+        // Fora do jogo a simulação fica parada; a loja e os menus mexem no estado dela
+        if (current_game_state != GAME)
+        {
+            sim.Pause();
+            sim_resume_pending = true;
+        }
+    }
+    sim.Stop();
+    if (ranch.print_profile)
+    {
+        profiler.Print(stdout, world.Size());
+        sim_profiler.Print(stdout, world.Size());
     }
+
     // Finalizamos o uso dos recursos do sistema operacional
     ma_device_uninit(&device);
     ma_decoder_uninit(&decoder_game);
@@ -2246,6 +2350,52 @@ void DrawVirtualObject(const char* object_name)
     glBindVertexArray(0);
 }
 
+// Liga o buffer de instâncias ao VAO do objeto: a matriz de modelo de cada
+// instância ocupa os atributos 3 a 6 (uma coluna por atributo) e avança uma
+// vez por instância, não por vértice. Veja "instance_model" em shader_vertex.glsl.
+void EnableInstancedAttributes(const char* object_name)
+{
+    glBindVertexArray(g_VirtualScene[object_name].vertex_array_object_id);
+    glBindBuffer(GL_ARRAY_BUFFER, g_InstanceBufferId);
+    for (GLuint column = 0; column < 4; column++)
+    {
+        GLuint location = 3 + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(location, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Substitui o conteúdo do buffer de instâncias. Alocar de novo a cada envio
+// evita esperar que a GPU termine o desenho anterior que usa o buffer.
+void UploadInstanceMatrices(const std::vector<glm::mat4>& matrices)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, g_InstanceBufferId);
+    glBufferData(GL_ARRAY_BUFFER, matrices.size() * sizeof(glm::mat4), matrices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Igual a DrawVirtualObject(), mas desenha "instance_count" cópias usando as
+// matrizes enviadas por UploadInstanceMatrices(). O uniform "instanced" deve
+// estar ligado.
+void DrawVirtualObjectInstanced(const char* object_name, GLsizei instance_count)
+{
+    const SceneObject& object = g_VirtualScene[object_name];
+    glBindVertexArray(object.vertex_array_object_id);
+    glUniform4f(g_bbox_min_uniform, object.bbox_min.x, object.bbox_min.y, object.bbox_min.z, 1.0f);
+    glUniform4f(g_bbox_max_uniform, object.bbox_max.x, object.bbox_max.y, object.bbox_max.z, 1.0f);
+    glDrawElementsInstanced(
+        object.rendering_mode,
+        object.num_indices,
+        GL_UNSIGNED_INT,
+        (void*)(object.first_index * sizeof(GLuint)),
+        instance_count
+    );
+    glBindVertexArray(0);
+}
+
 // Função que carrega os shaders de vértices e de fragmentos que serão
 // utilizados para renderização. Veja slides 180-200 do documento Aula_03_Rendering_Pipeline_Grafico.pdf.
 //
@@ -2289,6 +2439,7 @@ void LoadShadersFromFiles()
     g_bbox_min_uniform   = glGetUniformLocation(g_GpuProgramID, "bbox_min");
     g_bbox_max_uniform   = glGetUniformLocation(g_GpuProgramID, "bbox_max");
     tilingLocation       = glGetUniformLocation(g_GpuProgramID, "tiling_factor");
+    g_instanced_uniform  = glGetUniformLocation(g_GpuProgramID, "instanced"); // Variável "instanced" em shader_vertex.glsl
 
     // Variáveis em "shader_fragment.glsl" para acesso das imagens de textura
     glUseProgram(g_GpuProgramID);
@@ -2889,10 +3040,9 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
         g_IsSprinting = false;
 
         // Se o usuário apertar a tecla espaço, resetamos os ângulos de Euler para zero.
-    if (key == GLFW_KEY_SPACE && action == GLFW_PRESS && !g_IsJumping)
+    // O pulo em si começa no próximo tick da simulação (ver PlayerInput)
+    if (key == GLFW_KEY_SPACE && action == GLFW_PRESS)
     {
-        g_IsJumping = true;
-        g_CameraVerticalVelocity = JUMP_VELOCITY;
         g_Player_Started_Jumping = true;
     }
 
@@ -2947,6 +3097,130 @@ void TextRendering_ShowFramesPerSecond(GLFWwindow* window)
     TextRendering_PrintString(window, buffer, 1.0f-(numchars + 1)*charwidth, 1.0f-lineheight, 1.0f);
 }
 
+// Constrói a malha do chão a partir das amostras do relevo: um objeto por
+// bioma, todos no mesmo VAO, com coordenadas de textura de 0 a 1 em cada
+// bioma como as do "the_plane"
+void BuildTerrainAndAddToVirtualScene(const Terrain& terrain)
+{
+    GLuint vertex_array_object_id;
+    glGenVertexArrays(1, &vertex_array_object_id);
+    glBindVertexArray(vertex_array_object_id);
+
+    std::vector<GLuint> indices;
+    std::vector<float>  model_coefficients;
+    std::vector<float>  normal_coefficients;
+    std::vector<float>  texture_coefficients;
+
+    size_t tile_columns = terrain.Columns() / 3;
+    size_t tile_rows = terrain.Rows() / 3;
+    std::vector<float> xs, zs;
+    std::vector<glm::vec3> normals;
+
+    for (size_t tile = 0; tile < 9; ++tile)
+    {
+        size_t first_column = (tile % 3) * tile_columns;
+        size_t first_row = (tile / 3) * tile_rows;
+        GLuint first_vertex = (GLuint)(model_coefficients.size() / 4);
+        size_t first_index = indices.size();
+
+        // Normais de todas as amostras do bioma de uma vez
+        xs.clear();
+        zs.clear();
+        for (size_t row = 0; row <= tile_rows; ++row)
+        {
+            for (size_t column = 0; column <= tile_columns; ++column)
+            {
+                glm::vec2 position = terrain.SamplePosition(first_column + column, first_row + row);
+                xs.push_back(position.x);
+                zs.push_back(position.y);
+            }
+        }
+        normals.resize(xs.size());
+        terrain.Normals(xs.data(), zs.data(), normals.data(), xs.size());
+
+        glm::vec2 tile_min = terrain.SamplePosition(first_column, first_row);
+        glm::vec2 tile_max = terrain.SamplePosition(first_column + tile_columns, first_row + tile_rows);
+        glm::vec3 bbox_min = glm::vec3(tile_min.x, std::numeric_limits<float>::max(), tile_min.y);
+        glm::vec3 bbox_max = glm::vec3(tile_max.x, -std::numeric_limits<float>::max(), tile_max.y);
+
+        for (size_t row = 0; row <= tile_rows; ++row)
+        {
+            for (size_t column = 0; column <= tile_columns; ++column)
+            {
+                size_t k = row * (tile_columns + 1) + column;
+                float height = terrain.Sample(first_column + column, first_row + row);
+                model_coefficients.push_back( xs[k] );
+                model_coefficients.push_back( height );
+                model_coefficients.push_back( zs[k] );
+                model_coefficients.push_back( 1.0f );
+                normal_coefficients.push_back( normals[k].x );
+                normal_coefficients.push_back( normals[k].y );
+                normal_coefficients.push_back( normals[k].z );
+                normal_coefficients.push_back( 0.0f );
+                // Como no plano: U cresce com x e V cresce com -z
+                texture_coefficients.push_back( float(column) / tile_columns );
+                texture_coefficients.push_back( 1.0f - float(row) / tile_rows );
+                bbox_min.y = std::min(bbox_min.y, height);
+                bbox_max.y = std::max(bbox_max.y, height);
+            }
+        }
+
+        // Dois triângulos por célula, com a mesma orientação dos do plano
+        for (size_t row = 0; row < tile_rows; ++row)
+        {
+            for (size_t column = 0; column < tile_columns; ++column)
+            {
+                GLuint v00 = first_vertex + (GLuint)(row * (tile_columns + 1) + column);
+                GLuint v10 = v00 + 1;
+                GLuint v01 = v00 + (GLuint)(tile_columns + 1);
+                GLuint v11 = v01 + 1;
+                indices.push_back(v01); indices.push_back(v11); indices.push_back(v10);
+                indices.push_back(v01); indices.push_back(v10); indices.push_back(v00);
+            }
+        }
+
+        SceneObject theobject;
+        theobject.name           = "terrain_" + std::to_string(tile);
+        theobject.first_index    = first_index;
+        theobject.num_indices    = indices.size() - first_index;
+        theobject.rendering_mode = GL_TRIANGLES;
+        theobject.vertex_array_object_id = vertex_array_object_id;
+        theobject.bbox_min = bbox_min;
+        theobject.bbox_max = bbox_max;
+
+        g_VirtualScene[theobject.name] = theobject;
+    }
+
+    GLuint VBO_model_coefficients_id;
+    glGenBuffers(1, &VBO_model_coefficients_id);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_model_coefficients_id);
+    glBufferData(GL_ARRAY_BUFFER, model_coefficients.size() * sizeof(float), model_coefficients.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0); // "(location = 0)" em "shader_vertex.glsl"
+    glEnableVertexAttribArray(0);
+
+    GLuint VBO_normal_coefficients_id;
+    glGenBuffers(1, &VBO_normal_coefficients_id);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_normal_coefficients_id);
+    glBufferData(GL_ARRAY_BUFFER, normal_coefficients.size() * sizeof(float), normal_coefficients.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, 0); // "(location = 1)"
+    glEnableVertexAttribArray(1);
+
+    GLuint VBO_texture_coefficients_id;
+    glGenBuffers(1, &VBO_texture_coefficients_id);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_texture_coefficients_id);
+    glBufferData(GL_ARRAY_BUFFER, texture_coefficients.size() * sizeof(float), texture_coefficients.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, 0); // "(location = 2)"
+    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    GLuint indices_id;
+    glGenBuffers(1, &indices_id);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+}
+
 // Função para debugging: imprime no terminal todas informações de um modelo
 // geométrico carregado de um arquivo ".obj".
 // Veja: https://github.com/syoyo/tinyobjloader/blob/22883def8db9ef1f3ffb9b404318e7dd25fdbb51/loader_example.cc#L98
@@ -3136,3 +3410,18 @@ void data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uin
 
     (void)pInput;
 }
+
+std::map<Slime_Type, std::vector<int>> UpgradeCostTable(Upgrade upgrade)
+{
+    std::map<Slime_Type, std::vector<int>> costs;
+    for (int type = 0; type < SLIME_TYPE_COUNT; type++)
+    {
+        const int* levels = SLIME_TRAITS[type].upgrade_costs[upgrade];
+        costs[Slime_Type(type)] = std::vector<int>(levels, levels + UPGRADE_LEVELS);
+    }
+    return costs;
+}
+
+glm::vec4 WeaponPosition(glm::vec4 camera_position, glm::vec4 camera_view_vector, glm::vec4 camera_up_vector) {
+    return camera_position + 0.4f * normalize(camera_view_vector) - 0.25f * normalize(crossproduct(camera_up_vector, camera_view_vector)) - 0.1f * camera_up_vector;
+}
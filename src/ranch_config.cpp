@@ -0,0 +1,265 @@
+#include "ranch_config.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "creature.hpp"
+#include "creature_update.hpp"
+#include "creature_world.hpp"
+#include "fixed_timestep.hpp"
+#include "terrain.hpp"
+
+RanchConfig DefaultRanchConfig() {
+    RanchConfig config;
+    config.stress = false;
+    config.starting_slimes = STARTING_SLIMES;
+    config.slime_limit = SLIME_LIMIT;
+    config.spawn_rate = 0.0f;
+    config.map_size = DEFAULT_MAP_SIZE;
+    config.tick_rate = SIM_TICK_RATE;
+    config.seed = 0;
+    config.print_profile = false;
+    config.lod_distance = CREATURE_LOD_NEAR_DISTANCE;
+    config.lod_buckets = CREATURE_LOD_BUCKETS;
+    config.virtual_distance = WORLD_VIRTUAL_DISTANCE;
+    config.flocking = false;
+    config.terrain_relief = TERRAIN_RELIEF;
+    config.sim_thread = true;
+    config.catch_up = 0.0f;
+    config.idle_progress = true;
+    config.separation = true;
+    return config;
+}
+
+float StressMapSize(int population) {
+    // Os slimes nascem em 8 dos 9 biomas, cada um usando 90% do lado do bioma
+    const float usable_fraction = (8.0f / 9.0f) * 0.81f;
+    float side = std::sqrt(population * STRESS_AREA_PER_SLIME / usable_fraction);
+    return std::fmax(DEFAULT_MAP_SIZE, side / 2.0f);
+}
+
+static bool ParseInt(const std::string& key, const std::string& text, int& out) {
+    char* end = NULL;
+    long value = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || value < 0) {
+        fprintf(stderr, "ERROR: invalid value \"%s\" for %s.\n", text.c_str(), key.c_str());
+        return false;
+    }
+    out = (int)value;
+    return true;
+}
+
+// Contagem de slimes: cada slime vivo precisa de um handle do CreatureWorld
+static bool ParsePopulation(const std::string& key, const std::string& text, int& out) {
+    if (!ParseInt(key, text, out)) {
+        return false;
+    }
+    if ((uint32_t)out > SLOT_CAPACITY) {
+        fprintf(stderr, "ERROR: %s must be at most %u.\n", key.c_str(), SLOT_CAPACITY);
+        return false;
+    }
+    return true;
+}
+
+static bool ParseFloat(const std::string& key, const std::string& text, float& out) {
+    char* end = NULL;
+    float value = std::strtof(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || !(value >= 0.0f)) {
+        fprintf(stderr, "ERROR: invalid value \"%s\" for %s.\n", text.c_str(), key.c_str());
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+//Aplica uma opção (sem o "--") ao config
+static bool ApplyOption(const std::string& key, const std::string& value, RanchConfig& config, bool& map_size_given) {
+    if (key == "stress") {
+        int population;
+        if (!ParsePopulation(key, value, population)) {
+            return false;
+        }
+        config.stress = true;
+        config.print_profile = true;
+        config.starting_slimes = population;
+        config.slime_limit = population;
+        if (config.spawn_rate == 0.0f) {
+            config.spawn_rate = STRESS_SPAWN_RATE;
+        }
+        if (!map_size_given) {
+            config.map_size = StressMapSize(population);
+        }
+        return true;
+    }
+    if (key == "population") {
+        return ParsePopulation(key, value, config.starting_slimes);
+    }
+    if (key == "slime-limit") {
+        return ParsePopulation(key, value, config.slime_limit);
+    }
+    if (key == "spawn-rate") {
+        return ParseFloat(key, value, config.spawn_rate);
+    }
+    if (key == "map-size") {
+        map_size_given = true;
+        if (!ParseFloat(key, value, config.map_size)) {
+            return false;
+        }
+        if (config.map_size < 10.0f) {
+            fprintf(stderr, "ERROR: map-size must be at least 10.\n");
+            return false;
+        }
+        return true;
+    }
+    if (key == "tick-rate") {
+        if (!ParseFloat(key, value, config.tick_rate)) {
+            return false;
+        }
+        if (config.tick_rate < 1.0f) {
+            fprintf(stderr, "ERROR: tick-rate must be at least 1.\n");
+            return false;
+        }
+        return true;
+    }
+    if (key == "lod-distance") {
+        return ParseFloat(key, value, config.lod_distance);
+    }
+    if (key == "lod-buckets") {
+        if (!ParseInt(key, value, config.lod_buckets)) {
+            return false;
+        }
+        if (config.lod_buckets < 1) {
+            fprintf(stderr, "ERROR: lod-buckets must be at least 1.\n");
+            return false;
+        }
+        return true;
+    }
+    if (key == "virtual-distance") {
+        return ParseFloat(key, value, config.virtual_distance);
+    }
+    if (key == "flocking") {
+        int flocking = 0;
+        if (!ParseInt(key, value, flocking)) {
+            return false;
+        }
+        config.flocking = flocking != 0;
+        return true;
+    }
+    if (key == "terrain-relief") {
+        return ParseFloat(key, value, config.terrain_relief);
+    }
+    if (key == "sim-thread") {
+        int sim_thread = 0;
+        if (!ParseInt(key, value, sim_thread)) {
+            return false;
+        }
+        config.sim_thread = sim_thread != 0;
+        return true;
+    }
+    if (key == "catch-up") {
+        if (!ParseFloat(key, value, config.catch_up)) {
+            return false;
+        }
+        if (config.catch_up < 0.0f) {
+            fprintf(stderr, "ERROR: catch-up must not be negative.\n");
+            return false;
+        }
+        return true;
+    }
+    if (key == "idle-progress") {
+        int idle_progress = 0;
+        if (!ParseInt(key, value, idle_progress)) {
+            return false;
+        }
+        config.idle_progress = idle_progress != 0;
+        return true;
+    }
+    if (key == "separation") {
+        int separation = 0;
+        if (!ParseInt(key, value, separation)) {
+            return false;
+        }
+        config.separation = separation != 0;
+        return true;
+    }
+    if (key == "seed") {
+        char* end = NULL;
+        config.seed = std::strtoull(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0') {
+            fprintf(stderr, "ERROR: invalid value \"%s\" for seed.\n", value.c_str());
+            return false;
+        }
+        return true;
+    }
+    if (key == "profile") {
+        config.print_profile = value != "0" && value != "false";
+        return true;
+    }
+    fprintf(stderr, "ERROR: unknown option \"%s\".\n", key.c_str());
+    return false;
+}
+
+static bool LoadConfigFile(const std::string& filename, RanchConfig& config, bool& map_size_given) {
+    std::ifstream file(filename.c_str());
+    if (!file) {
+        fprintf(stderr, "ERROR: Cannot open config file \"%s\".\n", filename.c_str());
+        return false;
+    }
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        size_t equals = line.find('=');
+        std::string key, value;
+        std::istringstream(line.substr(0, equals)) >> key;
+        if (key.empty()) {
+            continue;
+        }
+        if (equals == std::string::npos) {
+            fprintf(stderr, "ERROR: %s:%d: expected \"key = value\".\n", filename.c_str(), line_number);
+            return false;
+        }
+        std::istringstream(line.substr(equals + 1)) >> value;
+        if (!ApplyOption(key, value, config, map_size_given)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LoadRanchConfigFile(const std::string& filename, RanchConfig& config) {
+    bool map_size_given = false;
+    return LoadConfigFile(filename, config, map_size_given);
+}
+
+bool ParseRanchArguments(int argc, char* argv[], RanchConfig& config) {
+    bool map_size_given = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            config.model_path = arg;
+            continue;
+        }
+        std::string key = arg.substr(2);
+        if (key == "profile") {
+            config.print_profile = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "ERROR: missing value for %s.\n", arg.c_str());
+            return false;
+        }
+        std::string value = argv[++i];
+        bool ok = key == "config" ? LoadConfigFile(value, config, map_size_given)
+                                  : ApplyOption(key, value, config, map_size_given);
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
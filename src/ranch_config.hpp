@@ -0,0 +1,64 @@
+#ifndef RANCH_CONFIG_HPP
+#define RANCH_CONFIG_HPP
+
+#include <cstdint>
+#include <string>
+
+#define DEFAULT_MAP_SIZE 300.0f      // Metade da largura do mapa (vai de -300 a 300)
+#define STRESS_SPAWN_RATE 100.0f     // Slimes por segundo no modo de estresse
+#define STRESS_AREA_PER_SLIME 50.0f  // m² de bioma por slime ao calcular o mapa do modo de estresse
+
+// Parâmetros do rancho escolhidos na linha de comando ou em arquivo.
+// Sem argumentos o jogo roda como sempre: 100 slimes iniciais, limite de
+// 1000 e nascimento no ritmo do upgrade de spawn.
+struct RanchConfig {
+    bool stress;           // Modo de estresse: população grande e perfil impresso ao sair
+    int starting_slimes;
+    int slime_limit;       // Total de slimes que podem nascer na partida
+    float spawn_rate;      // Slimes por segundo; 0 usa SLIME_SPAWN_TIME e o upgrade
+    float map_size;        // Metade da largura do mapa
+    float tick_rate;       // Ticks de simulação por segundo
+    uint64_t seed;         // 0 sorteia pelo relógio
+    bool print_profile;    // Imprime o tempo de cada etapa do quadro ao sair
+    float lod_distance;    // Raio dos slimes atualizados todo tick; 0 desliga o LOD
+    int lod_buckets;       // Grupos em rodízio dos slimes distantes
+    float virtual_distance; // Biomas mais longe que isso viram só contagem; 0 simula todos
+    bool flocking;         // Pulos seguem o bando (separação, bioma e fuga da arma)
+    float terrain_relief;  // Escala do relevo dos biomas; 0 deixa o chão plano
+    bool sim_thread;       // Simulação numa thread própria, separada do desenho
+    float catch_up;        // Segundos avançados de uma vez antes do primeiro quadro
+    bool idle_progress;    // O rancho avança o tempo passado no menu ao voltar
+    bool separation;       // Slimes sobrepostos são afastados a cada tick
+    std::string model_path; // Modelo OBJ extra, como no primeiro argumento antigo
+};
+
+RanchConfig DefaultRanchConfig();
+
+// Tamanho de mapa que comporta "population" slimes respeitando MIN_DISTANCE
+float StressMapSize(int population);
+
+// Lê opções no formato "--opção valor":
+//   --stress N          população N (inicial e limite), spawn e mapa do modo de estresse
+//   --population N      slimes iniciais
+//   --slime-limit N     total de slimes que podem nascer
+//   --spawn-rate R      slimes por segundo
+//   --map-size S        metade da largura do mapa
+//   --tick-rate T       ticks de simulação por segundo
+//   --seed S
+//   --profile           imprime o perfil de quadro ao sair
+//   --lod-distance D    raio do LOD da simulação (0 desliga)
+//   --lod-buckets N     slimes distantes são atualizados a cada N ticks
+//   --virtual-distance D biomas a mais de D metros guardam só a contagem (0 desliga)
+//   --flocking 0|1      liga o comportamento de bando
+//   --terrain-relief R  escala do relevo (0 deixa o chão plano)
+//   --sim-thread 0|1    simulação numa thread própria (padrão 1)
+//   --catch-up S        começa com o rancho S segundos adiantado
+//   --idle-progress 0|1 o tempo no menu conta para o rancho (padrão 1)
+//   --separation 0|1    afasta os slimes sobrepostos (padrão 1)
+//   --config arquivo    mesmas chaves em linhas "chave = valor" (# comenta)
+// Um argumento sem "--" é o modelo OBJ extra. Retorna false e imprime o
+// erro em stderr se algo for inválido.
+bool ParseRanchArguments(int argc, char* argv[], RanchConfig& config);
+bool LoadRanchConfigFile(const std::string& filename, RanchConfig& config);
+
+#endif // RANCH_CONFIG_HPP
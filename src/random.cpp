@@ -0,0 +1,10 @@
+#include "random.hpp"
+
+void CounterUniformBatch(uint64_t seed, const uint32_t* ids, size_t count, uint32_t tick, uint32_t stream, float* out) {
+    // Parte do hash que independe do slime é calculada uma vez só
+    uint64_t counter = ((uint64_t)tick << 32) | stream;
+    for (size_t k = 0; k < count; k++) {
+        uint64_t h = MixBits(MixBits(seed ^ ids[k]) ^ counter);
+        out[k] = (float)(h >> 40) * (1.0f / 16777216.0f);
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <cstddef>
+#include <stdint.h>
+
+// Gerador aleatório sem estado, baseado em contador (estilo SplitMix64).
+// O valor depende só de (seed, id, tick, stream), então qualquer thread pode
+// sortear para qualquer slime, em qualquer ordem, e a mesma seed sempre gera
+// o mesmo rancho.
+
+//Cada sorteio usa um stream diferente para não reaproveitar o mesmo número
+enum RandomStream {
+    RNG_JUMP_ROLL,
+    RNG_JUMP_ANGLE,
+    RNG_SPAWN_TYPE,
+    RNG_SPAWN_X,
+    RNG_SPAWN_Z,
+    RNG_SPAWN_PICK,    // Ponto ativo escolhido na amostragem de Poisson-disk
+    RNG_SPAWN_ANGLE,
+    RNG_TERRAIN,       // Relevo; o id carrega também a oitava do ruído
+    RNG_CATCH_UP_RADIUS, // Deslocamento sorteado por CatchUp() (Box-Muller)
+    RNG_CATCH_UP_ANGLE,
+    RNG_CATCH_UP_FACING
+};
+
+//Finalizador do SplitMix64
+inline uint64_t MixBits(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+inline uint64_t CounterHash(uint64_t seed, uint32_t id, uint32_t tick, uint32_t stream) {
+    uint64_t h = MixBits(seed ^ id);
+    return MixBits(h ^ (((uint64_t)tick << 32) | stream));
+}
+
+//Número uniforme em [0, 1)
+inline float CounterUniform(uint64_t seed, uint32_t id, uint32_t tick, uint32_t stream) {
+    return (float)(CounterHash(seed, id, tick, stream) >> 40) * (1.0f / 16777216.0f);
+}
+
+//Preenche out[k] = CounterUniform(seed, ids[k], tick, stream) para um lote de slimes
+void CounterUniformBatch(uint64_t seed, const uint32_t* ids, size_t count, uint32_t tick, uint32_t stream, float* out);
+
+#endif // RANDOM_HPP
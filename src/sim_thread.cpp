@@ -0,0 +1,105 @@
+#include "sim_thread.hpp"
+
+SimulationThread::SimulationThread(float tick_rate, int max_steps, bool threaded)
+    : clock(tick_rate, max_steps), last_time(Clock::now()), threaded(threaded), paused(true), busy(false), stopping(false) {
+}
+
+SimulationThread::~SimulationThread() {
+    Stop();
+}
+
+void SimulationThread::Start(const TickFunction& tick_function, const PublishFunction& publish_function) {
+    tick = tick_function;
+    publish = publish_function;
+    if (threaded && !thread.joinable()) {
+        thread = std::thread(&SimulationThread::Loop, this);
+    }
+}
+
+void SimulationThread::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void SimulationThread::Resume() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!paused.load()) {
+        return;
+    }
+    // Um tick que pediu a pausa pode ainda estar publicando
+    changed.wait(lock, [this] { return !busy; });
+    clock.Reset();
+    last_time = Clock::now();
+    paused = false;
+    changed.notify_all();
+}
+
+void SimulationThread::Pause() {
+    std::unique_lock<std::mutex> lock(mutex);
+    paused = true;
+    changed.notify_all();
+    changed.wait(lock, [this] { return !busy; });
+}
+
+bool SimulationThread::Paused() const {
+    return paused.load();
+}
+
+void SimulationThread::Poll() {
+    if (!threaded && !paused.load()) {
+        RunDueTicks();
+    }
+}
+
+bool SimulationThread::Threaded() const {
+    return threaded;
+}
+
+float SimulationThread::Step() const {
+    return clock.Step();
+}
+
+float SimulationThread::RunDueTicks() {
+    Clock::time_point now = Clock::now();
+    int steps = clock.Advance(std::chrono::duration<float>(now - last_time).count());
+    last_time = now;
+    int done = 0;
+    bool keep_running = true;
+    while (done < steps && keep_running && !paused.load()) {
+        keep_running = tick(clock.Step());
+        done++;
+    }
+    if (done > 0) {
+        publish(clock.Alpha());
+    }
+    if (!keep_running) {
+        paused = true;
+    }
+    return (1.0f - clock.Alpha()) * clock.Step();
+}
+
+// Espera pelo próximo tick com wait_for(), que acorda antes com Pause() e Stop()
+void SimulationThread::Loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        changed.wait(lock, [this] { return stopping || !paused.load(); });
+        if (stopping) {
+            return;
+        }
+        busy = true;
+        lock.unlock();
+        float wait = RunDueTicks();
+        lock.lock();
+        busy = false;
+        changed.notify_all();
+        if (!stopping && !paused.load()) {
+            changed.wait_for(lock, std::chrono::duration<float>(wait));
+        }
+    }
+}
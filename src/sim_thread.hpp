@@ -0,0 +1,108 @@
+#ifndef SIM_THREAD_HPP
+#define SIM_THREAD_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "fixed_timestep.hpp"
+
+// Dois buffers do estado publicado pela simulação: ela escreve sempre em
+// Back() e, no fim de um lote de ticks, troca os dois com Publish(). O
+// desenho lê o outro entre Lock() e Unlock(). Se o desenho estiver lendo, a
+// troca sem espera falha e a simulação segue; o próximo lote publica um
+// estado mais novo.
+template <typename T>
+class SnapshotBuffer {
+public:
+    SnapshotBuffer() : front(&buffers[0]), back(&buffers[1]) {}
+
+    T& Back() {
+        return *back;
+    }
+
+    // Retorna false se o desenho estava lendo e "wait" é false
+    bool Publish(bool wait) {
+        std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+        if (wait) {
+            lock.lock();
+        } else if (!lock.try_lock()) {
+            return false;
+        }
+        std::swap(front, back);
+        return true;
+    }
+
+    const T& Lock() {
+        mutex.lock();
+        return *front;
+    }
+
+    void Unlock() {
+        mutex.unlock();
+    }
+
+private:
+    T buffers[2];
+    T* front;
+    T* back;
+    std::mutex mutex;
+};
+
+// Roda a simulação em ticks de duração fixa numa thread própria, para a
+// espera do vsync no glfwSwapBuffers() não atrasar os ticks. Cada lote de
+// ticks devidos termina com "publish", que copia o estado para um
+// SnapshotBuffer. Sem "threaded" nada muda para quem usa: os ticks rodam
+// dentro de Poll(), na thread que chama.
+class SimulationThread {
+public:
+    // Recebe a duração do tick e retorna false para parar depois dele (a
+    // simulação fica pausada até o próximo Resume())
+    typedef std::function<bool(float delta_t)> TickFunction;
+    // Recebe a fração do próximo tick já decorrida, como FixedTimestep::Alpha()
+    typedef std::function<void(float alpha)> PublishFunction;
+
+    SimulationThread(float tick_rate, int max_steps, bool threaded);
+    ~SimulationThread(); // Chama Stop()
+
+    // Começa pausada; as funções rodam só na thread da simulação
+    void Start(const TickFunction& tick, const PublishFunction& publish);
+    void Stop();
+
+    // Volta a contar o tempo a partir de agora, sem ticks atrasados
+    void Resume();
+    // Retorna só depois do tick em andamento; a partir daí quem chama pode
+    // mexer no estado da simulação até o próximo Resume()
+    void Pause();
+    bool Paused() const;
+
+    void Poll(); // Sem thread própria, roda os ticks devidos desde a última chamada
+
+    bool Threaded() const;
+    float Step() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    float RunDueTicks(); // Retorna os segundos até o próximo tick
+    void Loop();
+
+    FixedTimestep clock;
+    Clock::time_point last_time;
+    TickFunction tick;
+    PublishFunction publish;
+    bool threaded;
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    std::atomic<bool> paused;
+    bool busy;     // A thread está rodando um lote de ticks
+    bool stopping;
+
+    SimulationThread(const SimulationThread&);
+    SimulationThread& operator=(const SimulationThread&);
+};
+
+#endif // SIM_THREAD_HPP
@@ -0,0 +1,97 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+// Pequena camada sobre os intrínsecos para escrever cada kernel uma única vez:
+// vfloat tem LANES floats, 8 com AVX2 e 4 com SSE2. Sem nenhum dos dois,
+// CREATURE_SIMD_AVX2 e CREATURE_SIMD_SSE2 ficam indefinidos e quem inclui usa
+// a versão escalar.
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__)
+    #define CREATURE_SIMD_AVX2
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CREATURE_SIMD_SSE2
+    #include <emmintrin.h>
+#endif
+
+#if defined(CREATURE_SIMD_AVX2) || defined(CREATURE_SIMD_SSE2)
+
+#if defined(CREATURE_SIMD_AVX2)
+typedef __m256 vfloat;
+typedef __m256i vint;
+static const size_t LANES = 8;
+static inline vfloat VLoad(const float* p) { return _mm256_loadu_ps(p); }
+static inline void VStore(float* p, vfloat v) { _mm256_storeu_ps(p, v); }
+static inline vfloat VSet(float f) { return _mm256_set1_ps(f); }
+static inline vfloat VAllOnes() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+static inline vfloat VAdd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+static inline vfloat VSub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+static inline vfloat VMul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+static inline vfloat VDiv(vfloat a, vfloat b) { return _mm256_div_ps(a, b); }
+static inline vfloat VSqrt(vfloat a) { return _mm256_sqrt_ps(a); }
+static inline vfloat VMin(vfloat a, vfloat b) { return _mm256_min_ps(a, b); }
+static inline vfloat VMax(vfloat a, vfloat b) { return _mm256_max_ps(a, b); }
+static inline vfloat VAnd(vfloat a, vfloat b) { return _mm256_and_ps(a, b); }
+static inline vfloat VAndNot(vfloat a, vfloat b) { return _mm256_andnot_ps(a, b); }
+static inline vfloat VOr(vfloat a, vfloat b) { return _mm256_or_ps(a, b); }
+static inline vfloat VLess(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static inline vfloat VLessEqual(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+static inline vfloat VEqual(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+static inline vfloat VSelect(vfloat mask, vfloat a, vfloat b) { return _mm256_blendv_ps(b, a, mask); }
+static inline int VMoveMask(vfloat v) { return _mm256_movemask_ps(v); }
+//Converte 8 flags (bytes) em máscara: todos os bits 1 onde o byte é diferente de zero
+static inline vfloat VMaskFromBytes(const unsigned char* p) {
+    __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p));
+    return _mm256_castsi256_ps(_mm256_cmpgt_epi32(v, _mm256_setzero_si256()));
+}
+static inline vint VToInt(vfloat v) { return _mm256_cvttps_epi32(v); } //Trunca em direção a zero
+static inline vfloat VToFloat(vint v) { return _mm256_cvtepi32_ps(v); }
+//base[index[k]] em cada posição k
+static inline vfloat VGather(const float* base, vint index) { return _mm256_i32gather_ps(base, index, 4); }
+#else
+typedef __m128 vfloat;
+typedef __m128i vint;
+static const size_t LANES = 4;
+static inline vfloat VLoad(const float* p) { return _mm_loadu_ps(p); }
+static inline void VStore(float* p, vfloat v) { _mm_storeu_ps(p, v); }
+static inline vfloat VSet(float f) { return _mm_set1_ps(f); }
+static inline vfloat VAllOnes() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+static inline vfloat VAdd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+static inline vfloat VSub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+static inline vfloat VMul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+static inline vfloat VDiv(vfloat a, vfloat b) { return _mm_div_ps(a, b); }
+static inline vfloat VSqrt(vfloat a) { return _mm_sqrt_ps(a); }
+static inline vfloat VMin(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+static inline vfloat VMax(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+static inline vfloat VAnd(vfloat a, vfloat b) { return _mm_and_ps(a, b); }
+static inline vfloat VAndNot(vfloat a, vfloat b) { return _mm_andnot_ps(a, b); }
+static inline vfloat VOr(vfloat a, vfloat b) { return _mm_or_ps(a, b); }
+static inline vfloat VLess(vfloat a, vfloat b) { return _mm_cmplt_ps(a, b); }
+static inline vfloat VLessEqual(vfloat a, vfloat b) { return _mm_cmple_ps(a, b); }
+static inline vfloat VEqual(vfloat a, vfloat b) { return _mm_cmpeq_ps(a, b); }
+static inline vfloat VSelect(vfloat mask, vfloat a, vfloat b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+static inline int VMoveMask(vfloat v) { return _mm_movemask_ps(v); }
+//Converte 4 flags (bytes) em máscara: todos os bits 1 onde o byte é diferente de zero
+static inline vfloat VMaskFromBytes(const unsigned char* p) {
+    int bits;
+    std::memcpy(&bits, p, sizeof(bits));
+    __m128i zero = _mm_setzero_si128();
+    __m128i v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero), zero);
+    return _mm_castsi128_ps(_mm_cmpgt_epi32(v, zero));
+}
+static inline vint VToInt(vfloat v) { return _mm_cvttps_epi32(v); } //Trunca em direção a zero
+static inline vfloat VToFloat(vint v) { return _mm_cvtepi32_ps(v); }
+//base[index[k]] em cada posição k; SSE2 não tem gather, então lê um por um
+static inline vfloat VGather(const float* base, vint index) {
+    int indices[4];
+    _mm_storeu_si128((__m128i*)indices, index);
+    return _mm_setr_ps(base[indices[0]], base[indices[1]], base[indices[2]], base[indices[3]]);
+}
+#endif
+
+#endif
+
+#endif // SIMD_HPP
@@ -1,244 +1,359 @@
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <vector>
 #include <ctime>
+#include <glm/vec2.hpp>
 #include <glm/gtc/constants.hpp>
 #include <glm/gtx/rotate_vector.hpp>
 #include <glm/gtx/vector_angle.hpp>
 #include "slime_types.hpp"
+#include "creature_world.hpp"
+#include "random.hpp"
 
-Anemo_Slime::Anemo_Slime(float x, float y, float z): Creature(x, y, z, 8.0f, 0.2f, -7.81f){
-};
-
-int Anemo_Slime::GetType() const {
-    return ANEMO;
-}
-
-Cryo_Slime::Cryo_Slime(float x, float y, float z) : Creature(x, y, z, 2.0f, 5.0f, -9.81f){
-};
+#define TILE_COUNT 9
+#define POISSON_CANDIDATES 12 // Candidatos no anel de cada slime ativo
 
-int Cryo_Slime::GetType() const {
-    return CRYO;
+//Tipo de slime sorteado pela chave "id", entre os SLIME_TYPE_COUNT tipos
+static Slime_Type RandomSpawnType(const CreatureWorld& world, uint32_t id)
+{
+    return Slime_Type(int(CounterUniform(world.seed, id, 0, RNG_SPAWN_TYPE) * SLIME_TYPE_COUNT));
 }
 
-Dendro_Slime::Dendro_Slime(float x, float y, float z) : Creature(x, y, z, 5.0f, 0.5f, -9.81f){
+//Retângulo onde os slimes de um bioma nascem, deixando 10% de margem
+struct SpawnArea
+{
+    float min_x, min_z;
+    float max_x, max_z;
 };
 
-int Dendro_Slime::GetType() const {
-    return DENDRO;
+static SpawnArea TileSpawnArea(int tile, float map_width, float map_length)
+{
+    float tile_width = 2.0f * map_width / 3.0f;
+    float tile_length = 2.0f * map_length / 3.0f;
+    SpawnArea area;
+    area.min_x = -map_width + tile_width * (tile % 3 + 0.1f);
+    area.max_x = -map_width + tile_width * (tile % 3 + 1.0f);
+    area.min_z = -map_length + tile_length * (tile / 3 + 0.1f);
+    area.max_z = -map_length + tile_length * (tile / 3 + 1.0f);
+    return area;
 }
 
-Plasma_Slime::Plasma_Slime(float x, float y, float z) : Creature(x, y, z, 4.0f, 1.0f, -9.81f){
-};
+// Grade auxiliar da amostragem de Poisson-disk: células de lado r/√2 cabem
+// no máximo um slime, então testar um candidato é ler 5x5 células seguidas
+// na memória, bem mais barato que a lista ligada da grade do pool.
+struct PoissonGrid
+{
+    SpawnArea area;
+    float r;
+    float inverse_cell_size;
+    int columns, rows;
+    std::vector<glm::vec2> cells; // NAN marca célula vazia
 
-int Plasma_Slime::GetType() const {
-    return PLASMA;
-}
+    PoissonGrid(SpawnArea area, float r) : area(area), r(r)
+    {
+        float cell_size = r / std::sqrt(2.0f);
+        inverse_cell_size = 1.0f / cell_size;
+        columns = std::max(1, int(std::ceil((area.max_x - area.min_x) * inverse_cell_size)) + 1);
+        rows = std::max(1, int(std::ceil((area.max_z - area.min_z) * inverse_cell_size)) + 1);
+        cells.assign(size_t(columns) * rows, glm::vec2(NAN, NAN));
+    }
 
-Fire_Slime::Fire_Slime(float x, float y, float z) : Creature(x, y, z, 6.0f, 0.75f, -8.81f){
-};
+    int Column(float x) const { return std::min(columns - 1, int((x - area.min_x) * inverse_cell_size)); }
+    int Row(float z) const { return std::min(rows - 1, int((z - area.min_z) * inverse_cell_size)); }
 
-int Fire_Slime::GetType() const {
-    return FIRE;
-}
+    bool Free(float x, float z) const
+    {
+        int column = Column(x), row = Row(z);
+        for (int cz = std::max(0, row - 2); cz <= std::min(rows - 1, row + 2); cz++) 
+        {
+            for (int cx = std::max(0, column - 2); cx <= std::min(columns - 1, column + 2); cx++) 
+            {
+                glm::vec2 other = cells[size_t(cz) * columns + cx];
+                float dx = other.x - x, dz = other.y - z;
+                if (dx * dx + dz * dz < r * r) // Falso para célula vazia (NAN)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
 
-Geo_Slime::Geo_Slime(float x, float y, float z) : Creature(x, y, z, 4.0f, 0.3f, -14.81f){
+    void Insert(float x, float z)
+    {
+        cells[size_t(Row(z)) * columns + Column(x)] = glm::vec2(x, z);
+    }
 };
 
-int Geo_Slime::GetType() const {
-    return GEO;
-}
-
-Electro_Slime::Electro_Slime(float x, float y, float z) : Creature(x, y, z, 3.0f, 1.5f, -9.81f){
-};
+// Amostragem de Poisson-disk (Bridson, na variante de Roberts): os candidatos
+// ficam logo além de r ao redor de um slime "ativo" já colocado, em ângulos
+// igualmente espaçados a partir de um ângulo sorteado; um ativo sem vizinho
+// possível sai da lista. Um candidato aprovado pela PoissonGrid ainda passa
+// pelas grades do mundo, que conhecem os slimes que já estavam no bioma. Os
+// sorteios são chaveados por "key" e um contador, então a mesma seed gera as
+// mesmas posições.
+static size_t PoissonDiskFill(CreatureWorld& world, Slime_Type type, SpawnArea area, size_t count, uint32_t key)
+{
+    const float r = Creature::MIN_DISTANCE;
+    const float distance = r * 1.001f;
+    PoissonGrid local(area, r);
+    std::vector<glm::vec2> active;
+    uint32_t draw = 0;
+    size_t placed = 0;
+    while (placed < count) 
+    {
+        if (active.empty()) 
+        {
+            // Semente em um ponto livre qualquer; se nenhum for achado o bioma está cheio
+            bool seeded = false;
+            for (int attempt = 0; attempt < SPAWN_CANDIDATES && !seeded; attempt++, draw++) 
+            {
+                float x = area.min_x + (area.max_x - area.min_x) * CounterUniform(world.seed, key, draw, RNG_SPAWN_X);
+                float z = area.min_z + (area.max_z - area.min_z) * CounterUniform(world.seed, key, draw, RNG_SPAWN_Z);
+                if (local.Free(x, z) && !world.AnyInRadius(x, z, r)) 
+                {
+                    if (world.Add(type, x, world.GroundHeight(x, z), z) == CREATURE_HANDLE_NONE)
+                    {
+                        return placed; // Sem handles livres
+                    }
+                    local.Insert(x, z);
+                    active.push_back(glm::vec2(x, z));
+                    placed++;
+                    seeded = true;
+                }
+            }
+            if (!seeded) 
+            {
+                break;
+            }
+            continue;
+        }
 
-int Electro_Slime::GetType() const {
-    return ELECTRO;
+        size_t k = size_t(CounterUniform(world.seed, key, draw, RNG_SPAWN_PICK) * active.size());
+        float first_angle = CounterUniform(world.seed, key, draw, RNG_SPAWN_ANGLE) * glm::two_pi<float>();
+        draw++;
+        bool found = false;
+        for (int attempt = 0; attempt < POISSON_CANDIDATES && !found; attempt++) 
+        {
+            float angle = first_angle + attempt * (glm::two_pi<float>() / POISSON_CANDIDATES);
+            float x = active[k].x + distance * std::cos(angle);
+            float z = active[k].y + distance * std::sin(angle);
+            if (x < area.min_x || x > area.max_x || z < area.min_z || z > area.max_z) 
+            {
+                continue;
+            }
+            if (local.Free(x, z) && !world.AnyInRadius(x, z, r)) 
+            {
+                if (world.Add(type, x, world.GroundHeight(x, z), z) == CREATURE_HANDLE_NONE)
+                {
+                    return placed;
+                }
+                local.Insert(x, z);
+                active.push_back(glm::vec2(x, z));
+                placed++;
+                found = true;
+            }
+        }
+        if (!found) 
+        {
+            active[k] = active.back();
+            active.pop_back();
+        }
+    }
+    return placed;
 }
-Water_Slime::Water_Slime(float x, float y, float z) : Creature(x, y, z, 4.5f, 0.75f, -9.81f){
-};
 
-int Water_Slime::GetType() const {
-    return WATER;
+// Quantos slimes cabem na área pela densidade que o modo de estresse usa
+// (2·MIN_DISTANCE² por slime), abaixo do que a amostragem de Poisson-disk
+// alcança; assim um bioma virtual nunca guarda mais do que dá para recolocar
+static uint32_t VirtualCapacity(SpawnArea area)
+{
+    float r = Creature::MIN_DISTANCE;
+    return uint32_t((area.max_x - area.min_x) * (area.max_z - area.min_z) / (2.0f * r * r));
 }
 
 //Cada tipo de slime e inicializado em seu bioma. Usado pro primeiro spawn do jogo
-std::vector<Creature*> InitialCreatureSpawn(int count, float map_width, float map_length) 
+size_t InitialCreatureSpawn(CreatureWorld& world, int count, float map_width, float map_length) 
 {
-    std::vector<Creature*> creatures;
-    Creature* new_creature;
-    Slime_Type type;
-    bool valid_position;
-    int tile;
-    float x, z;
-    float distance;
-    constexpr int TILE_COUNT = 9;
-
+    // Quantos slimes de cada tipo, o i-ésimo sorteado pela chave next_id + i.
+    // Os ids de verdade vêm depois, na ordem dos tipos, e não seguem o sorteio.
+    size_t type_count[SLIME_TYPE_COUNT] = {0};
     for (int i = 0; i < count; i++) 
     {
-        type = Slime_Type(rand() % (TILE_COUNT - 1));
-        valid_position = false;
-        switch (type) 
+        type_count[RandomSpawnType(world, world.next_id + i)]++;
+    }
+
+    size_t placed = 0;
+    for (int type = 0; type < SLIME_TYPE_COUNT; type++) 
+    {
+        int tile = SLIME_TRAITS[type].tile;
+        SpawnArea area = TileSpawnArea(tile, map_width, map_length);
+        if (world.IsVirtual(tile)) 
         {
-            case ANEMO:
-                tile = 0;
-                break;
-            case CRYO:
-                tile = 1;
-                break;
-            case DENDRO:
-                tile = 2;
-                break;
-            case PLASMA:
-                tile = 3;
-                break;
-            case FIRE:
-                tile = 5;
-                break;
-            case GEO:
-                tile = 6;
-                break;
-            case ELECTRO:
-                tile = 7;
-                break;
-            case WATER:
-                tile = 8;
-                break;
+            // Bioma longe do jogador: só conta, até a capacidade
+            size_t room = VirtualCapacity(area) - std::min(VirtualCapacity(area), world.VirtualCount(tile));
+            for (size_t k = 0; k < std::min(room, type_count[type]); k++, placed++) 
+            {
+                world.AddVirtual(tile, Slime_Type(type));
+            }
+            continue;
         }
-        while (!valid_position) 
+        world.Chunk(tile).Reserve(world.Chunk(tile).Size() + type_count[type]);
+        placed += PoissonDiskFill(world, Slime_Type(type), area, type_count[type], world.next_id);
+    }
+    return placed;
+}
+
+// Liga na grade de cada chunk o controle de células vazias, com a região 0
+// formada pelas células cujo centro está na área de spawn do bioma
+static void TrackSpawnAreas(CreatureWorld& world, float map_width, float map_length)
+{
+    for (int tile = 0; tile < TILE_COUNT; tile++) 
+    {
+        SpawnArea area = TileSpawnArea(tile, map_width, map_length);
+        SpatialGrid& grid = world.Chunk(tile).grid;
+        std::vector<int> cell_region(grid.CellCount(), -1);
+        for (uint32_t c = 0; c < cell_region.size(); c++) 
         {
-            x = -280 + (200 * (tile % 3)) + (static_cast<float>(rand()) / RAND_MAX) * 180;
-            z = -280 + (200 * (tile / 3)) + (static_cast<float>(rand()) / RAND_MAX) * 180;
-            for (const auto& creature : creatures) 
+            glm::vec2 center = grid.CellCenter(c);
+            if (center.x >= area.min_x && center.x <= area.max_x &&
+                center.y >= area.min_z && center.y <= area.max_z) 
             {
-                distance = glm::distance(glm::vec2(x, z), glm::vec2(creature->GetPosition().x, creature->GetPosition().z));
-                if (distance < Creature::MIN_DISTANCE) 
-                {
-                    valid_position = false;
-                    break;
-                }
-            } 
-           valid_position = true;
+                cell_region[c] = 0;
+            }
         }
+        grid.TrackEmptyCells(cell_region, 1);
+    }
+}
 
-        new_creature = nullptr;
-        switch (type) 
+//Spawns continuos: cada slime nasce em uma célula vazia do seu bioma
+size_t SpawnCreatures(CreatureWorld& world, size_t count, float map_width, float map_length) 
+{
+    if (!world.Chunk(0).grid.TracksEmptyCells()) 
+    {
+        TrackSpawnAreas(world, map_width, map_length);
+    }
+    size_t placed = 0;
+    for (size_t n = 0; n < count; n++) 
+    {
+        uint32_t id = world.next_id; // Sorteios chaveados pelo id que o novo slime vai receber
+        Slime_Type type = RandomSpawnType(world, id);
+        int tile = SLIME_TRAITS[type].tile;
+        SpawnArea area = TileSpawnArea(tile, map_width, map_length);
+        if (world.IsVirtual(tile)) 
         {
-            case ANEMO:
-                new_creature = new Anemo_Slime(x, Creature::GROUND_LEVEL, z);
-                break;
-            case CRYO:
-                new_creature = new Cryo_Slime(x, Creature::GROUND_LEVEL, z);
-                break;
-            case DENDRO:
-                new_creature = new Dendro_Slime(x, Creature::GROUND_LEVEL, z);
-                break;
-            case PLASMA:
-                new_creature = new Plasma_Slime(x, Creature::GROUND_LEVEL, z);
-                break;
-            case FIRE:
-                new_creature = new Fire_Slime(x, Creature::GROUND_LEVEL, z);
-                break;
-            case GEO:
-                new_creature = new Geo_Slime(x, Creature::GROUND_LEVEL, z);
-                break;
-            case ELECTRO:
-                new_creature = new Electro_Slime(x, Creature::GROUND_LEVEL, z);
-                break;
-            case WATER:
-                new_creature = new Water_Slime(x, Creature::GROUND_LEVEL, z);
-                break;
+            if (world.VirtualCount(tile) < VirtualCapacity(area)) 
+            {
+                world.AddVirtual(tile, type);
+                placed++;
+            }
+            continue;
         }
-        if (new_creature) 
+        const SpatialGrid& grid = world.Chunk(tile).grid;
+        const float cell_size = grid.CellSize();
+
+        for (uint32_t attempt = 0; attempt < SPAWN_CANDIDATES; attempt++) 
         {
-            creatures.push_back(new_creature);
+            float x, z;
+            size_t empty = grid.EmptyCellCount(0);
+            if (empty > 0) 
+            {
+                // Ponto dentro de uma célula vazia; ainda pode haver vizinho na célula ao lado
+                uint32_t c = grid.EmptyCell(0, std::min(empty - 1, size_t(CounterUniform(world.seed, id, attempt, RNG_SPAWN_PICK) * empty)));
+                glm::vec2 center = grid.CellCenter(c);
+                x = center.x + cell_size * (CounterUniform(world.seed, id, attempt, RNG_SPAWN_X) - 0.5f);
+                z = center.y + cell_size * (CounterUniform(world.seed, id, attempt, RNG_SPAWN_Z) - 0.5f);
+                x = std::min(std::max(x, area.min_x), area.max_x);
+                z = std::min(std::max(z, area.min_z), area.max_z);
+            } 
+            else 
+            {
+                // Sem célula vazia ainda pode haver espaço entre slimes de células vizinhas
+                x = area.min_x + (area.max_x - area.min_x) * CounterUniform(world.seed, id, attempt, RNG_SPAWN_X);
+                z = area.min_z + (area.max_z - area.min_z) * CounterUniform(world.seed, id, attempt, RNG_SPAWN_Z);
+            }
+            // O bioma vizinho pode ter slimes a menos de MIN_DISTANCE da borda
+            if (!world.AnyInRadius(x, z, Creature::MIN_DISTANCE)) 
+            {
+                if (world.Add(type, x, world.GroundHeight(x, z), z) == CREATURE_HANDLE_NONE)
+                {
+                    return placed; // Sem handles livres
+                }
+                placed++;
+                break;
+            }
         }
     }
+    return placed;
+}
 
-    return creatures;
+CreatureHandle SpawnCreature(CreatureWorld& world, float map_width, float map_length) 
+{
+    uint32_t id = world.next_id;
+    size_t tile = (size_t)SLIME_TRAITS[RandomSpawnType(world, id)].tile;
+    if (SpawnCreatures(world, 1, map_width, map_length) == 0 || world.IsVirtual(tile)) 
+    {
+        return CREATURE_HANDLE_NONE;
+    }
+    // O novo slime é o último do chunk do seu bioma
+    return world.Chunk(tile).handle[world.Chunk(tile).Size() - 1];
 }
 
-//Cada tipo de slime e inicializado em seu bioma. Usaado para spawns continuos
-Creature* SpawnCreature(float map_width, float map_length, std::vector<Creature*> creatures) 
+// Recoloca a população virtual do bioma por amostragem de Poisson-disk, cada
+// tipo com a sua chave derivada da chave guardada, então o mesmo rancho volta
+// sempre igual. Os slimes recebem ids novos e começam parados. Os que não
+// couberam (bioma cheio ou sem handles) voltam para a contagem do chunk.
+static size_t MaterializeChunk(CreatureWorld& world, size_t tile, float map_width, float map_length)
 {
-    Creature* creature;
-    Slime_Type type;
-    bool valid_position;
-    int tile;
-    float x, z;
-    float distance;
-    constexpr int TILE_COUNT = 9;
-
-    type = Slime_Type(rand() % (TILE_COUNT - 1));
-    valid_position = false;
-    switch (type) 
+    uint32_t count[SLIME_TYPE_COUNT];
+    uint32_t key;
+    world.TakeVirtual(tile, count, key);
+    SpawnArea area = TileSpawnArea(int(tile), map_width, map_length);
+    size_t total = 0;
+    for (int type = 0; type < SLIME_TYPE_COUNT; type++) 
     {
-        case ANEMO:
-            tile = 0;
-            break;
-        case CRYO:
-            tile = 1;
-            break;
-        case DENDRO:
-            tile = 2;
-            break;
-        case PLASMA:
-            tile = 3;
-            break;
-        case FIRE:
-            tile = 5;
-            break;
-        case GEO:
-            tile = 6;
-            break;
-        case ELECTRO:
-            tile = 7;
-            break;
-        case WATER:
-            tile = 8;
-            break;
+        total += count[type];
     }
-    while (!valid_position) 
+    world.Chunk(tile).Reserve(world.Chunk(tile).Size() + total);
+    size_t placed = 0;
+    for (int type = 0; type < SLIME_TYPE_COUNT; type++) 
     {
-        x = -280 + (200 * (tile % 3)) + (static_cast<float>(rand()) / RAND_MAX) * 180;
-        z = -280 + (200 * (tile / 3)) + (static_cast<float>(rand()) / RAND_MAX) * 180;
-        for (const auto& creature : creatures) 
-        {
-            distance = glm::distance(glm::vec2(x, z), glm::vec2(creature->GetPosition().x, creature->GetPosition().z));
-            if (distance < Creature::MIN_DISTANCE) 
-            {
-                valid_position = false;
-                break;
-            }
-        } 
-        valid_position = true;
+        size_t type_placed = PoissonDiskFill(world, Slime_Type(type), area, count[type], key * SLIME_TYPE_COUNT + type);
+        count[type] -= uint32_t(type_placed);
+        placed += type_placed;
     }
+    world.ReturnVirtual(tile, count);
+    return placed;
+}
 
-    creature = nullptr;
-    switch (type) 
+size_t StreamVirtualChunks(CreatureWorld& world, float x, float z, float distance, float map_width, float map_length)
+{
+    size_t changed = 0;
+    for (size_t tile = 0; tile < world.ChunkCount(); tile++) 
     {
-        case ANEMO:
-            creature = new Anemo_Slime(x, Creature::GROUND_LEVEL, z);
-            break;
-        case CRYO:
-            creature = new Cryo_Slime(x, Creature::GROUND_LEVEL, z);
-            break;
-        case DENDRO:
-            creature = new Dendro_Slime(x, Creature::GROUND_LEVEL, z);
-            break;
-        case PLASMA:
-            creature = new Plasma_Slime(x, Creature::GROUND_LEVEL, z);
-            break;
-        case FIRE:
-            creature = new Fire_Slime(x, Creature::GROUND_LEVEL, z);
-            break;
-        case GEO:
-            creature = new Geo_Slime(x, Creature::GROUND_LEVEL, z);
-            break;
-        case ELECTRO:
-            creature = new Electro_Slime(x, Creature::GROUND_LEVEL, z);
-            break;
-        case WATER:
-            creature = new Water_Slime(x, Creature::GROUND_LEVEL, z);
-            break;
+        float tile_distance = world.ChunkDistance(tile, x, z);
+        if (world.IsVirtual(tile) && tile_distance < distance) 
+        {
+            MaterializeChunk(world, tile, map_width, map_length);
+            changed++;
+        } 
+        else if (!world.IsVirtual(tile) && world.VirtualCount(tile) > 0 && tile_distance < distance) 
+        {
+            // Sobra de uma recolocação anterior: tenta de novo, agora que os slimes se moveram
+            if (MaterializeChunk(world, tile, map_width, map_length) > 0) 
+            {
+                changed++;
+            }
+        }
+        else if (!world.IsVirtual(tile) && tile_distance > distance + WORLD_VIRTUAL_MARGIN) 
+        {
+            // A chave vem do tick e do bioma, para cada recolhida recolocar de um jeito
+            if (world.Collapse(tile, world.Tick() * uint32_t(TILE_COUNT) + uint32_t(tile))) 
+            {
+                changed++;
+            }
+        }
     }
-    return creature;
-}
\ No newline at end of file
+    return changed;
+}
@@ -2,72 +2,122 @@
 
 #ifndef SLIME_TYPES_HPP
 #define SLIME_TYPES_HPP
+#include <stdint.h>
+#include <string>
 enum Slime_Type {ANEMO, CRYO, DENDRO, PLASMA, FIRE, GEO, ELECTRO, WATER};
-inline std::string to_string(Slime_Type t)
-{
-    switch (t)
-    {
-        case ANEMO:   return "Anemo";
-        case CRYO:    return "Cryo";
-        case DENDRO:  return "Dendro";
-        case PLASMA:  return "Plasma";
-        case FIRE:    return "Fire";
-        case GEO:     return "Geo";
-        case ELECTRO: return "Electro";
-        case WATER:   return "Water";
-        default:      return "Invalid Slime Type";
-    }
-}
+#define SLIME_TYPE_COUNT 8
 
-class Anemo_Slime: public Creature {
-    public:
-        Anemo_Slime(float x, float y, float z);
-        int GetType() const override;
+//Parâmetros de pulo e gravidade de cada tipo, guardados uma única vez por tipo
+struct SlimeParams {
+    float jump_velocity;
+    float jump_chance;
+    float gravity;
 };
 
-class Cryo_Slime: public Creature {
-    public:
-        Cryo_Slime(float x, float y, float z);
-        int GetType() const override;
-};
+#define SLIME_MESH_MAX_PARTS 16
 
-class Dendro_Slime: public Creature {
-    public:
-        Dendro_Slime(float x, float y, float z);
-        int GetType() const override;
+//Partes do modelo de cada tipo e a transformação aplicada antes da posição/rotação
+struct SlimeMesh {
+    const char* parts[SLIME_MESH_MAX_PARTS];
+    int part_count;
+    bool rotate_x;  // Modelo deitado, precisa girar 3π/2 em X
+    float scale;
 };
 
-class Plasma_Slime: public Creature {
-    public:
-        Plasma_Slime(float x, float y, float z);
-        int GetType() const override;
-};
+//Upgrades da loja; cada um custa slimes de alguns tipos em cada nível
+enum Upgrade {UPGRADE_MOVEMENT_SPEED, UPGRADE_STAMINA, UPGRADE_SPAWN_RATE, UPGRADE_INVENTORY, UPGRADE_LORE};
+#define UPGRADE_COUNT 5
+#define UPGRADE_LEVELS 3
 
-class Fire_Slime: public Creature {
-    public:
-        Fire_Slime(float x, float y, float z);
-        int GetType() const override;
+// Tudo o que muda de um tipo de slime para outro, numa tabela só
+struct SlimeTraits {
+    const char* name;
+    SlimeParams params;
+    SlimeMesh mesh;
+    int object_id; // object_id do shader, que escolhe a textura do tipo
+    int tile;      // Bioma (0 a 8, em linhas de 3, o mesmo índice do chunk em CreatureWorld) onde o tipo nasce
+    int upgrade_costs[UPGRADE_COUNT][UPGRADE_LEVELS]; // Slimes deste tipo pagos por nível de cada upgrade
 };
 
-class Geo_Slime: public Creature {
-    public:
-        Geo_Slime(float x, float y, float z);
-        int GetType() const override;
+constexpr SlimeTraits SLIME_TRAITS[SLIME_TYPE_COUNT] = {
+    {"Anemo", {8.0f, 0.2f, -7.81f}, {{"anemo1", "anemo2", "anemo3"}, 3, false, 1.0f},
+     3, 0, {{0, 2, 5}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {1, 4, 10}}},
+    {"Cryo", {2.0f, 5.0f, -9.81f}, {{"cryo1", "cryo2"}, 2, true, 1.0f},
+     4, 1, {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {2, 3, 5}, {4, 6, 10}}},
+    {"Dendro", {5.0f, 0.5f, -9.81f},
+     {{"dendro1", "dendro2", "dendro3", "dendro4", "dendro5", "dendro6", "dendro7", "dendro8",
+       "dendro9", "dendro10", "dendro11", "dendro12", "dendro13", "dendro14", "dendro15", "dendro16"}, 16, true, 1.0f},
+     5, 2, {{0, 0, 0}, {0, 0, 0}, {0, 2, 5}, {0, 0, 0}, {1, 4, 10}}},
+    {"Plasma", {4.0f, 1.0f, -9.81f}, {{"plasma1", "plasma2", "plasma3"}, 3, false, 0.01f},
+     6, 3, {{0, 0, 0}, {0, 0, 0}, {2, 3, 5}, {0, 0, 0}, {4, 6, 10}}},
+    {"Fire", {6.0f, 0.75f, -8.81f}, {{"fire1", "fire2"}, 2, false, 0.01f},
+     7, 5, {{0, 0, 0}, {2, 3, 5}, {0, 0, 0}, {0, 0, 0}, {4, 6, 10}}},
+    {"Geo", {4.0f, 0.3f, -14.81f}, {{"geo1"}, 1, false, 0.01f},
+     8, 6, {{0, 0, 0}, {0, 2, 5}, {0, 0, 0}, {0, 0, 0}, {1, 4, 10}}},
+    {"Electro", {3.0f, 1.5f, -9.81f}, {{"electro1", "electro2", "electro3"}, 3, false, 0.01f},
+     9, 7, {{2, 3, 5}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {4, 6, 10}}},
+    {"Water", {4.5f, 0.75f, -9.81f}, {{"water1", "water2"}, 2, false, 0.01f},
+     10, 8, {{0, 0, 0}, {0, 0, 0}, {0, 2, 5}, {0, 2, 5}, {1, 5, 10}}},
 };
 
-class Electro_Slime: public Creature {
-    public:
-        Electro_Slime(float x, float y, float z);
-        int GetType() const override;
+// Os traços de um tipo conhecido na compilação, para os caminhos
+// especializados por tipo (as constantes entram direto no código)
+template <Slime_Type T>
+struct SlimeTypeTraits {
+    static constexpr Slime_Type type = T;
+    static constexpr float jump_velocity = SLIME_TRAITS[T].params.jump_velocity;
+    static constexpr float gravity = SLIME_TRAITS[T].params.gravity;
 };
 
-class Water_Slime: public Creature {
-    public:
-        Water_Slime(float x, float y, float z);
-        int GetType() const override;
-};
+// Chama visitor.template Visit<T>() com o tipo de "type" em tempo de
+// compilação. É o único desvio por tipo: quem despacha um lote inteiro de
+// slimes do mesmo tipo paga um desvio por lote, não por slime.
+template <typename Visitor>
+inline void DispatchSlimeType(Slime_Type type, Visitor& visitor)
+{
+    switch (type)
+    {
+        case ANEMO:   visitor.template Visit<ANEMO>(); break;
+        case CRYO:    visitor.template Visit<CRYO>(); break;
+        case DENDRO:  visitor.template Visit<DENDRO>(); break;
+        case PLASMA:  visitor.template Visit<PLASMA>(); break;
+        case FIRE:    visitor.template Visit<FIRE>(); break;
+        case GEO:     visitor.template Visit<GEO>(); break;
+        case ELECTRO: visitor.template Visit<ELECTRO>(); break;
+        case WATER:   visitor.template Visit<WATER>(); break;
+    }
+}
+
+inline std::string to_string(Slime_Type t)
+{
+    return t >= 0 && t < SLIME_TYPE_COUNT ? SLIME_TRAITS[t].name : "Invalid Slime Type";
+}
+
+class CreatureWorld;
+typedef uint32_t CreatureHandle;
+
+#define SPAWN_CANDIDATES 30 // Tentativas de posição por slime antes de desistir
+
+// Cria "count" slimes, cada tipo no chunk do seu bioma, por amostragem de
+// Poisson-disk: nenhum fica a menos de Creature::MIN_DISTANCE de outro. Se um
+// bioma lotar, cria menos slimes (nos virtuais, só conta até a capacidade);
+// retorna quantos foram criados.
+size_t InitialCreatureSpawn(CreatureWorld& world, int count, float map_width, float map_length);
+// Cria um slime de tipo sorteado em uma posição livre do seu bioma. Retorna
+// o handle dele, ou CREATURE_HANDLE_NONE se o bioma não tem espaço ou é virtual.
+CreatureHandle SpawnCreature(CreatureWorld& world, float map_width, float map_length);
+// Cria até "count" slimes de uma vez, como SpawnCreature(). A posição sai da
+// lista de células vazias que a grade do chunk do bioma mantém, então cada
+// slime custa O(1) amortizado mesmo com o mapa quase cheio. Retorna quantos
+// foram criados. Nos biomas virtuais os slimes novos só entram na conta do
+// bioma, até a quantidade que a amostragem consegue recolocar.
+size_t SpawnCreatures(CreatureWorld& world, size_t count, float map_width, float map_length);
 
-std::vector<Creature*> InitialCreatureSpawn(int count, float map_width, float map_length);
-Creature* SpawnCreature(float map_width, float map_length, std::vector<Creature*> creatures);
+// Biomas a menos de "distance" de (x, z) ganham de volta os seus slimes,
+// recolocados de forma determinística pela contagem e pela chave guardadas;
+// os que ficam a mais de distance + WORLD_VIRTUAL_MARGIN viram só contagem
+// (ver CreatureWorld). Os que não couberam seguem na contagem e são tentados
+// de novo nas chamadas seguintes. Retorna quantos biomas mudaram.
+size_t StreamVirtualChunks(CreatureWorld& world, float x, float z, float distance, float map_width, float map_length);
 
 #endif
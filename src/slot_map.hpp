@@ -0,0 +1,121 @@
+#ifndef SLOT_MAP_HPP
+#define SLOT_MAP_HPP
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+// Handle de um SlotMap: o índice do slot nos bits baixos e a geração do slot
+// nos altos. A geração muda a cada Remove(), então um handle guardado depois
+// que o elemento saiu não encontra o elemento que reaproveitou o slot.
+typedef uint32_t SlotHandle;
+#define SLOT_HANDLE_NONE 0u       // Nunca é devolvido por Insert()
+#define SLOT_INDEX_BITS 22        // Até 4M slots vivos
+#define SLOT_CAPACITY (1u << SLOT_INDEX_BITS) // Slots que cabem nos bits do índice
+#define SLOT_GENERATION_MAX 1023u // Gerações em [1, SLOT_GENERATION_MAX]; a 0 fica para SLOT_HANDLE_NONE
+
+inline uint32_t SlotHandleIndex(SlotHandle handle) {
+    return handle & ((1u << SLOT_INDEX_BITS) - 1);
+}
+
+inline uint32_t SlotHandleGeneration(SlotHandle handle) {
+    return handle >> SLOT_INDEX_BITS;
+}
+
+// Tabela de valores endereçados por handles estáveis. Inserir e remover são
+// O(1): os slots liberados ficam numa lista livre e são reaproveitados pelo
+// próximo Insert(). O valor costuma ser onde o elemento está de fato (ver
+// CreatureWorld), atualizado com Set() quando quem guarda o elemento o move.
+template <typename T>
+class SlotMap {
+public:
+    SlotMap() : free_head(NO_SLOT), live(0) {}
+
+    size_t Size() const {
+        return live;
+    }
+
+    void Reserve(size_t capacity) {
+        slots.reserve(capacity);
+    }
+
+    // Esquece todos os elementos; os handles antigos continuam inválidos
+    void Clear() {
+        for (size_t s = 0; s < slots.size(); s++) {
+            if (slots[s].alive) {
+                Release((uint32_t)s);
+            }
+        }
+    }
+
+    // Sem slot livre e com SLOT_CAPACITY slots já criados
+    bool Full() const {
+        return free_head == NO_SLOT && slots.size() >= SLOT_CAPACITY;
+    }
+
+    // SLOT_HANDLE_NONE se Full(); o índice de um slot novo não pode invadir os bits da geração
+    SlotHandle Insert(const T& value) {
+        uint32_t s;
+        if (free_head != NO_SLOT) {
+            s = free_head;
+            free_head = slots[s].next_free;
+        } else if (slots.size() >= SLOT_CAPACITY) {
+            return SLOT_HANDLE_NONE;
+        } else {
+            s = (uint32_t)slots.size();
+            Slot slot;
+            slot.generation = 1;
+            slots.push_back(slot);
+        }
+        slots[s].value = value;
+        slots[s].alive = true;
+        live++;
+        return slots[s].generation << SLOT_INDEX_BITS | s;
+    }
+
+    // Ignora handles que já não são válidos
+    void Remove(SlotHandle handle) {
+        if (Contains(handle)) {
+            Release(SlotHandleIndex(handle));
+        }
+    }
+
+    bool Contains(SlotHandle handle) const {
+        uint32_t s = SlotHandleIndex(handle);
+        return s < slots.size() && slots[s].alive && slots[s].generation == SlotHandleGeneration(handle);
+    }
+
+    // NULL se o elemento já saiu
+    const T* Get(SlotHandle handle) const {
+        return Contains(handle) ? &slots[SlotHandleIndex(handle)].value : NULL;
+    }
+
+    // Troca o valor de um handle válido
+    void Set(SlotHandle handle, const T& value) {
+        slots[SlotHandleIndex(handle)].value = value;
+    }
+
+private:
+    static const uint32_t NO_SLOT = 0xFFFFFFFFu;
+
+    struct Slot {
+        T value;
+        uint32_t generation;
+        uint32_t next_free;
+        bool alive;
+    };
+
+    void Release(uint32_t s) {
+        slots[s].alive = false;
+        slots[s].generation = slots[s].generation == SLOT_GENERATION_MAX ? 1 : slots[s].generation + 1;
+        slots[s].next_free = free_head;
+        free_head = s;
+        live--;
+    }
+
+    std::vector<Slot> slots;
+    uint32_t free_head;
+    size_t live;
+};
+
+#endif // SLOT_MAP_HPP
@@ -0,0 +1,284 @@
+#include "spatial_grid.hpp"
+#include <algorithm>
+#include <cmath>
+#include "curve.hpp"
+
+const uint32_t SpatialGrid::NONE;
+
+SpatialGrid::SpatialGrid(float half_size, float cell_size, glm::vec2 center) {
+    Resize(half_size, cell_size, center);
+}
+
+void SpatialGrid::Resize(float new_half_size, float new_cell_size, glm::vec2 center) {
+    half_size = new_half_size;
+    min_x = center.x - new_half_size;
+    min_z = center.y - new_half_size;
+    cell_size = new_cell_size;
+    inverse_cell_size = 1.0f / new_cell_size;
+    cells_per_side = std::max(1, (int)std::ceil(2.0f * new_half_size / new_cell_size));
+    head.assign((size_t)cells_per_side * cells_per_side, NONE);
+    count.assign(head.size(), 0);
+    region.clear();
+    empty_slot.clear();
+    empty_cells.clear();
+    for (uint32_t i = 0; i < (uint32_t)cell.size(); i++) {
+        cell[i] = NONE;
+        Link(i, CellZ(position_z[i]) * cells_per_side + CellX(position_x[i]));
+    }
+}
+
+size_t SpatialGrid::Size() const {
+    return cell.size();
+}
+
+void SpatialGrid::Reserve(size_t capacity) {
+    cell.reserve(capacity);
+    next.reserve(capacity);
+    prev.reserve(capacity);
+    position_x.reserve(capacity);
+    position_y.reserve(capacity);
+    position_z.reserve(capacity);
+}
+
+void SpatialGrid::Clear() {
+    std::fill(head.begin(), head.end(), NONE);
+    std::fill(count.begin(), count.end(), 0);
+    for (uint32_t c = 0; c < region.size(); c++) {
+        MarkEmpty(c);
+    }
+    cell.clear();
+    next.clear();
+    prev.clear();
+    position_x.clear();
+    position_y.clear();
+    position_z.clear();
+}
+
+void SpatialGrid::ShrinkToFit() {
+    cell.shrink_to_fit();
+    next.shrink_to_fit();
+    prev.shrink_to_fit();
+    position_x.shrink_to_fit();
+    position_y.shrink_to_fit();
+    position_z.shrink_to_fit();
+}
+
+int SpatialGrid::CellX(float x) const {
+    int c = (int)std::floor((x - min_x) * inverse_cell_size);
+    return std::min(std::max(c, 0), cells_per_side - 1);
+}
+
+int SpatialGrid::CellZ(float z) const {
+    int c = (int)std::floor((z - min_z) * inverse_cell_size);
+    return std::min(std::max(c, 0), cells_per_side - 1);
+}
+
+//Coloca o item no início da lista da célula
+void SpatialGrid::Link(uint32_t item, uint32_t c) {
+    cell[item] = c;
+    prev[item] = NONE;
+    next[item] = head[c];
+    if (head[c] != NONE) {
+        prev[head[c]] = item;
+    }
+    head[c] = item;
+    if (count[c]++ == 0 && !region.empty()) {
+        MarkOccupied(c);
+    }
+}
+
+void SpatialGrid::Unlink(uint32_t item) {
+    if (prev[item] != NONE) {
+        next[prev[item]] = next[item];
+    } else {
+        head[cell[item]] = next[item];
+    }
+    if (next[item] != NONE) {
+        prev[next[item]] = prev[item];
+    }
+    if (--count[cell[item]] == 0 && !region.empty()) {
+        MarkEmpty(cell[item]);
+    }
+}
+
+uint32_t SpatialGrid::Insert(float x, float y, float z) {
+    uint32_t item = (uint32_t)cell.size();
+    cell.push_back(NONE);
+    next.push_back(NONE);
+    prev.push_back(NONE);
+    position_x.push_back(x);
+    position_y.push_back(y);
+    position_z.push_back(z);
+    Link(item, CellZ(z) * cells_per_side + CellX(x));
+    return item;
+}
+
+void SpatialGrid::Move(uint32_t item, float x, float y, float z) {
+    position_x[item] = x;
+    position_y[item] = y;
+    position_z[item] = z;
+    uint32_t c = CellZ(z) * cells_per_side + CellX(x);
+    if (c != cell[item]) {
+        Unlink(item);
+        Link(item, c);
+    }
+}
+
+void SpatialGrid::Remove(uint32_t item) {
+    uint32_t last = (uint32_t)cell.size() - 1;
+    Unlink(item);
+    if (item != last) {
+        // O último item assume o índice removido; os vizinhos passam a apontar para ele
+        cell[item] = cell[last];
+        next[item] = next[last];
+        prev[item] = prev[last];
+        position_x[item] = position_x[last];
+        position_y[item] = position_y[last];
+        position_z[item] = position_z[last];
+        if (prev[item] != NONE) {
+            next[prev[item]] = item;
+        } else {
+            head[cell[item]] = item;
+        }
+        if (next[item] != NONE) {
+            prev[next[item]] = item;
+        }
+    }
+    cell.pop_back();
+    next.pop_back();
+    prev.pop_back();
+    position_x.pop_back();
+    position_y.pop_back();
+    position_z.pop_back();
+}
+
+size_t SpatialGrid::QueryRadius(float x, float z, float radius, std::vector<uint32_t>& out) const {
+    size_t found = 0;
+    float radius2 = radius * radius;
+    int min_x = CellX(x - radius), max_x = CellX(x + radius);
+    int min_z = CellZ(z - radius), max_z = CellZ(z + radius);
+    for (int cz = min_z; cz <= max_z; cz++) {
+        for (int cx = min_x; cx <= max_x; cx++) {
+            for (uint32_t i = head[cz * cells_per_side + cx]; i != NONE; i = next[i]) {
+                float dx = position_x[i] - x;
+                float dz = position_z[i] - z;
+                if (dx * dx + dz * dz < radius2) {
+                    out.push_back(i);
+                    found++;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+bool SpatialGrid::AnyInRadius(float x, float z, float radius) const {
+    float radius2 = radius * radius;
+    int min_x = CellX(x - radius), max_x = CellX(x + radius);
+    int min_z = CellZ(z - radius), max_z = CellZ(z + radius);
+    for (int cz = min_z; cz <= max_z; cz++) {
+        for (int cx = min_x; cx <= max_x; cx++) {
+            for (uint32_t i = head[cz * cells_per_side + cx]; i != NONE; i = next[i]) {
+                float dx = position_x[i] - x;
+                float dz = position_z[i] - z;
+                if (dx * dx + dz * dz < radius2) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+size_t SpatialGrid::QueryAABB(glm::vec3 min, glm::vec3 max, std::vector<uint32_t>& out) const {
+    size_t found = 0;
+    for (int cz = CellZ(min.z); cz <= CellZ(max.z); cz++) {
+        for (int cx = CellX(min.x); cx <= CellX(max.x); cx++) {
+            for (uint32_t i = head[cz * cells_per_side + cx]; i != NONE; i = next[i]) {
+                if (position_x[i] >= min.x && position_x[i] <= max.x &&
+                    position_y[i] >= min.y && position_y[i] <= max.y &&
+                    position_z[i] >= min.z && position_z[i] <= max.z) {
+                    out.push_back(i);
+                    found++;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+size_t SpatialGrid::QueryCone(const WeaponCone& cone, std::vector<uint32_t>& out) const {
+    size_t found = 0;
+    int min_x = CellX(cone.box_min.x), max_x = CellX(cone.box_max.x);
+    int min_z = CellZ(cone.box_min.z), max_z = CellZ(cone.box_max.z);
+    for (int cz = min_z; cz <= max_z; cz++) {
+        for (int cx = min_x; cx <= max_x; cx++) {
+            for (uint32_t i = head[cz * cells_per_side + cx]; i != NONE; i = next[i]) {
+                glm::vec4 position(position_x[i], position_y[i], position_z[i], 1.0f);
+                if (InWeaponCone(cone, position)) {
+                    out.push_back(i);
+                    found++;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+size_t SpatialGrid::CellCount() const {
+    return head.size();
+}
+
+glm::vec2 SpatialGrid::CellCenter(uint32_t c) const {
+    float x = min_x + ((c % cells_per_side) + 0.5f) * cell_size;
+    float z = min_z + ((c / cells_per_side) + 0.5f) * cell_size;
+    return glm::vec2(x, z);
+}
+
+float SpatialGrid::CellSize() const {
+    return cell_size;
+}
+
+void SpatialGrid::TrackEmptyCells(const std::vector<int>& cell_region, int region_count) {
+    region = cell_region;
+    empty_slot.assign(head.size(), NONE);
+    empty_cells.assign(region_count, std::vector<uint32_t>());
+    for (uint32_t c = 0; c < head.size(); c++) {
+        if (count[c] == 0) {
+            MarkEmpty(c);
+        }
+    }
+}
+
+bool SpatialGrid::TracksEmptyCells() const {
+    return !region.empty();
+}
+
+size_t SpatialGrid::EmptyCellCount(int r) const {
+    return r < (int)empty_cells.size() ? empty_cells[r].size() : 0;
+}
+
+uint32_t SpatialGrid::EmptyCell(int r, size_t k) const {
+    return empty_cells[r][k];
+}
+
+void SpatialGrid::MarkEmpty(uint32_t c) {
+    if (region[c] < 0 || empty_slot[c] != NONE) {
+        return;
+    }
+    empty_slot[c] = (uint32_t)empty_cells[region[c]].size();
+    empty_cells[region[c]].push_back(c);
+}
+
+//Tira a célula da lista de vazias trocando com a última da lista
+void SpatialGrid::MarkOccupied(uint32_t c) {
+    if (region[c] < 0 || empty_slot[c] == NONE) {
+        return;
+    }
+    std::vector<uint32_t>& list = empty_cells[region[c]];
+    uint32_t moved = list.back();
+    list[empty_slot[c]] = moved;
+    empty_slot[moved] = empty_slot[c];
+    list.pop_back();
+    empty_slot[c] = NONE;
+}
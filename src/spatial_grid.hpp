@@ -0,0 +1,90 @@
+#ifndef SPATIAL_GRID_HPP
+#define SPATIAL_GRID_HPP
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+struct WeaponCone;
+
+#define GRID_CELL_SIZE 5.0f // Metros; igual a MIN_DISTANCE, então a busca de spawn olha no máximo 3x3 células
+
+// Grade uniforme no plano XZ cobrindo o quadrado de lado 2·half_size em volta
+// de "center" (a origem, se não for dado). Cada item é
+// um índice denso (0..Size()-1), o mesmo do CreaturePool, e cada célula guarda
+// uma lista ligada dos seus itens, então mover um item de célula é O(1).
+// Itens fora do mapa ficam nas células da borda.
+class SpatialGrid {
+public:
+    SpatialGrid(float half_size = 300.0f, float cell_size = GRID_CELL_SIZE, glm::vec2 center = glm::vec2(0.0f));
+
+    // Recria a grade com outro tamanho, mantendo os itens
+    void Resize(float half_size, float cell_size, glm::vec2 center = glm::vec2(0.0f));
+
+    size_t Size() const;
+    void Reserve(size_t capacity);
+    void Clear();
+    void ShrinkToFit();
+
+    uint32_t Insert(float x, float y, float z);  // Novo item recebe o índice Size()
+    void Move(uint32_t item, float x, float y, float z);
+    // Remove "item" e move o último para o seu índice, como CreaturePool::Remove()
+    void Remove(uint32_t item);
+
+    // Consultas: acrescentam os itens encontrados em "out" e retornam quantos
+    // Distância no plano XZ até (x, z) menor que radius
+    size_t QueryRadius(float x, float z, float radius, std::vector<uint32_t>& out) const;
+    bool AnyInRadius(float x, float z, float radius) const;
+    // Itens dentro da caixa [min, max]
+    size_t QueryAABB(glm::vec3 min, glm::vec3 max, std::vector<uint32_t>& out) const;
+    // Itens no cone da arma (InWeaponCone()), olhando só as células que a
+    // caixa do cone toca
+    size_t QueryCone(const WeaponCone& cone, std::vector<uint32_t>& out) const;
+
+    // Espaço livre: cada célula pode pertencer a uma região (ou -1) e a grade
+    // mantém, por região, a lista das células vazias, atualizada em O(1)
+    // quando um item entra ou sai de uma célula. Resize() desliga o controle.
+    size_t CellCount() const;
+    glm::vec2 CellCenter(uint32_t cell) const;
+    float CellSize() const;
+    void TrackEmptyCells(const std::vector<int>& cell_region, int region_count);
+    bool TracksEmptyCells() const;
+    size_t EmptyCellCount(int region) const;
+    uint32_t EmptyCell(int region, size_t k) const;
+
+private:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    int CellX(float x) const;
+    int CellZ(float z) const;
+    void Link(uint32_t item, uint32_t cell);
+    void Unlink(uint32_t item);
+    void MarkEmpty(uint32_t cell);
+    void MarkOccupied(uint32_t cell);
+
+    float half_size;
+    float min_x, min_z; // Canto da primeira célula
+    float cell_size;
+    float inverse_cell_size;
+    int cells_per_side;
+    std::vector<uint32_t> head;  // Primeiro item de cada célula
+    std::vector<uint32_t> count; // Itens em cada célula
+
+    // Controle de espaço livre (vazio se desligado)
+    std::vector<int> region;                        // Região de cada célula
+    std::vector<uint32_t> empty_slot;               // Posição da célula na lista de vazias da sua região
+    std::vector<std::vector<uint32_t> > empty_cells; // Células vazias de cada região
+
+    // Por item
+    std::vector<uint32_t> cell;
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> prev;
+    std::vector<float> position_x;
+    std::vector<float> position_y;
+    std::vector<float> position_z;
+};
+
+#endif // SPATIAL_GRID_HPP
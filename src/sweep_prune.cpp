@@ -0,0 +1,295 @@
+#include "sweep_prune.hpp"
+#include <algorithm>
+
+const uint32_t SweepAndPrune::MAX_FLAG;
+
+// Acima disso (fração das caixas vivas) Update() ordena tudo de novo em vez
+// de levar cada caixa nova do fim da lista até o seu lugar
+#define SWEEP_REBUILD_FRACTION 0.25f
+
+static inline uint64_t PairKey(uint32_t a, uint32_t b) {
+    return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+}
+
+inline bool SweepAndPrune::Before(const Endpoint& a, const Endpoint& b) {
+    return a.value < b.value || (a.value == b.value && (a.data & MAX_FLAG) < (b.data & MAX_FLAG));
+}
+
+SweepAndPrune::SweepAndPrune() : added(0), live(0), swaps(0) {
+}
+
+size_t SweepAndPrune::Size() const {
+    return live;
+}
+
+void SweepAndPrune::Clear() {
+    for (int axis = 0; axis < 2; axis++) {
+        endpoints[axis].clear();
+        endpoint_slot[axis].clear();
+    }
+    box_min.clear();
+    box_max.clear();
+    user.clear();
+    alive.clear();
+    dirty.clear();
+    pair_count.clear();
+    free_proxies.clear();
+    removed.clear();
+    moved.clear();
+    pairs.clear();
+    pair_slot.clear();
+    added = 0;
+    live = 0;
+    swaps = 0;
+}
+
+SweepAndPrune::Proxy SweepAndPrune::Add(glm::vec3 min, glm::vec3 max, uint32_t value) {
+    Proxy proxy;
+    if (!free_proxies.empty()) {
+        proxy = free_proxies.back();
+        free_proxies.pop_back();
+        box_min[proxy] = min;
+        box_max[proxy] = max;
+        user[proxy] = value;
+        alive[proxy] = 1;
+        dirty[proxy] = 0;
+        pair_count[proxy] = 0;
+    } else {
+        proxy = (Proxy)box_min.size();
+        box_min.push_back(min);
+        box_max.push_back(max);
+        user.push_back(value);
+        alive.push_back(1);
+        dirty.push_back(0);
+        pair_count.push_back(0);
+        for (int axis = 0; axis < 2; axis++) {
+            endpoint_slot[axis].resize(box_min.size() * 2);
+        }
+    }
+    // Entram no fim das listas e Update() os leva até o lugar
+    for (int axis = 0; axis < 2; axis++) {
+        int component = axis == 0 ? 0 : 2;
+        Endpoint start = {min[component], proxy << 1};
+        Endpoint end = {max[component], proxy << 1 | MAX_FLAG};
+        endpoint_slot[axis][start.data] = (uint32_t)endpoints[axis].size();
+        endpoints[axis].push_back(start);
+        endpoint_slot[axis][end.data] = (uint32_t)endpoints[axis].size();
+        endpoints[axis].push_back(end);
+    }
+    added++;
+    live++;
+    return proxy;
+}
+
+void SweepAndPrune::Move(Proxy proxy, glm::vec3 min, glm::vec3 max) {
+    if (box_min[proxy] == min && box_max[proxy] == max) {
+        return;
+    }
+    box_min[proxy] = min;
+    box_max[proxy] = max;
+    if (!dirty[proxy]) {
+        dirty[proxy] = 1;
+        moved.push_back(proxy);
+    }
+}
+
+void SweepAndPrune::Remove(Proxy proxy) {
+    if (!Alive(proxy)) {
+        return;
+    }
+    alive[proxy] = 0;
+    removed.push_back(proxy);
+    live--;
+}
+
+bool SweepAndPrune::Alive(Proxy proxy) const {
+    return proxy < alive.size() && alive[proxy];
+}
+
+uint32_t SweepAndPrune::User(Proxy proxy) const {
+    return user[proxy];
+}
+
+size_t SweepAndPrune::PairCount() const {
+    return pairs.size();
+}
+
+size_t SweepAndPrune::Swaps() const {
+    return swaps;
+}
+
+size_t SweepAndPrune::GetPairs(std::vector<Pair>& out) const {
+    size_t found = 0;
+    for (size_t k = 0; k < pairs.size(); k++) {
+        Proxy a = (Proxy)(pairs[k] >> 32);
+        Proxy b = (Proxy)(pairs[k] & 0xFFFFFFFFu);
+        if (box_min[a].y <= box_max[b].y && box_max[a].y >= box_min[b].y) {
+            out.push_back(Pair(a, b));
+            found++;
+        }
+    }
+    return found;
+}
+
+// Mesmo critério de CheckAABBOverlap()
+bool SweepAndPrune::OverlapXZ(Proxy a, Proxy b) const {
+    return box_min[a].x <= box_max[b].x && box_max[a].x >= box_min[b].x &&
+           box_min[a].z <= box_max[b].z && box_max[a].z >= box_min[b].z;
+}
+
+void SweepAndPrune::AddPair(Proxy a, Proxy b) {
+    uint64_t key = PairKey(a, b);
+    if (pair_slot.insert(std::make_pair(key, (uint32_t)pairs.size())).second) {
+        pairs.push_back(key);
+        pair_count[a]++;
+        pair_count[b]++;
+    }
+}
+
+// Swap-and-pop na lista densa
+void SweepAndPrune::RemovePair(Proxy a, Proxy b) {
+    if (pair_count[a] == 0 || pair_count[b] == 0) {
+        return;
+    }
+    std::unordered_map<uint64_t, uint32_t>::iterator found = pair_slot.find(PairKey(a, b));
+    if (found == pair_slot.end()) {
+        return;
+    }
+    uint32_t slot = found->second;
+    pair_slot.erase(found);
+    pair_count[a]--;
+    pair_count[b]--;
+    if (slot + 1 < pairs.size()) {
+        pairs[slot] = pairs.back();
+        pair_slot[pairs[slot]] = slot;
+    }
+    pairs.pop_back();
+}
+
+// Tira das listas os extremos e os pares das caixas removidas
+void SweepAndPrune::Compact() {
+    for (int axis = 0; axis < 2; axis++) {
+        std::vector<Endpoint>& list = endpoints[axis];
+        size_t kept = 0;
+        for (size_t k = 0; k < list.size(); k++) {
+            if (alive[list[k].data >> 1]) {
+                list[kept++] = list[k];
+            }
+        }
+        list.resize(kept);
+    }
+    for (size_t k = 0; k < pairs.size();) {
+        Proxy a = (Proxy)(pairs[k] >> 32);
+        Proxy b = (Proxy)(pairs[k] & 0xFFFFFFFFu);
+        if (alive[a] && alive[b]) {
+            k++;
+        } else {
+            RemovePair(a, b); // Traz o último para "k"
+        }
+    }
+    for (int axis = 0; axis < 2; axis++) {
+        RefreshSlots(axis);
+    }
+    free_proxies.insert(free_proxies.end(), removed.begin(), removed.end());
+    removed.clear();
+}
+
+void SweepAndPrune::RefreshSlots(int axis) {
+    const std::vector<Endpoint>& list = endpoints[axis];
+    for (size_t k = 0; k < list.size(); k++) {
+        endpoint_slot[axis][list[k].data] = (uint32_t)k;
+    }
+}
+
+// Só os extremos das caixas que se moveram
+void SweepAndPrune::RefreshValues(int axis) {
+    std::vector<Endpoint>& list = endpoints[axis];
+    int component = axis == 0 ? 0 : 2;
+    for (size_t m = 0; m < moved.size(); m++) {
+        Proxy proxy = moved[m];
+        if (alive[proxy]) {
+            list[endpoint_slot[axis][proxy << 1]].value = box_min[proxy][component];
+            list[endpoint_slot[axis][proxy << 1 | MAX_FLAG]].value = box_max[proxy][component];
+        }
+    }
+}
+
+// Cada extremo anda para a esquerda até o seu lugar. Andar para a direita é
+// o mesmo que os outros passarem por ele, então só a esquerda precisa de eventos.
+void SweepAndPrune::InsertionSort(int axis) {
+    std::vector<Endpoint>& list = endpoints[axis];
+    for (size_t k = 1; k < list.size(); k++) {
+        Endpoint moving = list[k];
+        size_t j = k;
+        while (j > 0 && Before(moving, list[j - 1])) {
+            const Endpoint& passed = list[j - 1];
+            bool moving_is_end = (moving.data & MAX_FLAG) != 0;
+            bool passed_is_end = (passed.data & MAX_FLAG) != 0;
+            if (!moving_is_end && passed_is_end) {
+                // O início passou para antes do fim da outra: podem se sobrepor
+                if (OverlapXZ(moving.data >> 1, passed.data >> 1)) {
+                    AddPair(moving.data >> 1, passed.data >> 1);
+                }
+            } else if (moving_is_end && !passed_is_end) {
+                // O fim passou para antes do início da outra: separaram neste eixo
+                RemovePair(moving.data >> 1, passed.data >> 1);
+            }
+            list[j] = passed;
+            endpoint_slot[axis][passed.data] = (uint32_t)j;
+            j--;
+            swaps++;
+        }
+        if (j != k) {
+            list[j] = moving;
+            endpoint_slot[axis][moving.data] = (uint32_t)j;
+        }
+    }
+}
+
+void SweepAndPrune::Rebuild() {
+    pairs.clear();
+    pair_slot.clear();
+    std::fill(pair_count.begin(), pair_count.end(), 0);
+    for (int axis = 0; axis < 2; axis++) {
+        RefreshValues(axis);
+        std::vector<Endpoint>& list = endpoints[axis];
+        std::sort(list.begin(), list.end(), Before);
+        RefreshSlots(axis);
+    }
+    // Varredura em X com as caixas abertas; o teste completo filtra Z
+    std::vector<Proxy> open;
+    const std::vector<Endpoint>& list = endpoints[0];
+    for (size_t k = 0; k < list.size(); k++) {
+        Proxy proxy = list[k].data >> 1;
+        if (list[k].data & MAX_FLAG) {
+            open.erase(std::find(open.begin(), open.end(), proxy));
+            continue;
+        }
+        for (size_t o = 0; o < open.size(); o++) {
+            if (OverlapXZ(proxy, open[o])) {
+                AddPair(proxy, open[o]);
+            }
+        }
+        open.push_back(proxy);
+    }
+}
+
+void SweepAndPrune::Update() {
+    swaps = 0;
+    if (!removed.empty()) {
+        Compact();
+    }
+    if (added > 0 && added >= live * SWEEP_REBUILD_FRACTION) {
+        Rebuild();
+    } else {
+        for (int axis = 0; axis < 2; axis++) {
+            RefreshValues(axis);
+            InsertionSort(axis);
+        }
+    }
+    for (size_t m = 0; m < moved.size(); m++) {
+        dirty[moved[m]] = 0;
+    }
+    moved.clear();
+    added = 0;
+}
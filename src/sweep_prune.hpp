@@ -0,0 +1,88 @@
+#ifndef SWEEP_PRUNE_HPP
+#define SWEEP_PRUNE_HPP
+
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include <glm/vec3.hpp>
+
+// Broad phase "sweep and prune" persistente, para caixas que se movem pouco
+// de um tick para o outro. Os extremos das caixas ficam ordenados nos eixos
+// X e Z e Update() os reordena com insertion sort: quase tudo já está no
+// lugar, então, fora uma passada linear pelas listas, o custo acompanha
+// quantas caixas se moveram e quantos extremos trocaram de posição. Um
+// par só pode começar ou deixar de se sobrepor quando o início de uma caixa
+// troca com o fim da outra, e é nessa troca que o conjunto de pares muda.
+// O eixo Y (os pulos) só é testado ao ler os pares.
+class SweepAndPrune {
+public:
+    typedef uint32_t Proxy;
+    typedef std::pair<Proxy, Proxy> Pair;
+
+    SweepAndPrune();
+
+    size_t Size() const; // Caixas vivas
+    void Clear();
+
+    // Mudanças valem a partir do próximo Update(). O proxy de uma caixa
+    // removida só é reaproveitado depois dele.
+    Proxy Add(glm::vec3 min, glm::vec3 max, uint32_t user);
+    void Move(Proxy proxy, glm::vec3 min, glm::vec3 max);
+    void Remove(Proxy proxy);
+    bool Alive(Proxy proxy) const;
+    uint32_t User(Proxy proxy) const;
+
+    void Update();
+
+    size_t PairCount() const; // Pares no plano XZ, antes do teste em Y
+    // Acrescenta em "out" os pares que se sobrepõem nos três eixos, com o
+    // menor proxy primeiro, e retorna quantos
+    size_t GetPairs(std::vector<Pair>& out) const;
+    size_t Swaps() const; // Trocas de extremos no último Update()
+
+private:
+    static const uint32_t MAX_FLAG = 1u; // Bit baixo de Endpoint::data: fim da caixa
+
+    struct Endpoint {
+        float value;
+        uint32_t data; // proxy << 1 | MAX_FLAG se for o fim
+    };
+
+    // Ordem das listas: em empate o início vem antes do fim, então caixas que
+    // só se tocam contam como par, como em OverlapXZ()
+    static bool Before(const Endpoint& a, const Endpoint& b);
+    bool OverlapXZ(Proxy a, Proxy b) const;
+    void AddPair(Proxy a, Proxy b);
+    void RemovePair(Proxy a, Proxy b);
+    void Compact();
+    void RefreshSlots(int axis);
+    void RefreshValues(int axis);
+    void InsertionSort(int axis);
+    void Rebuild();
+
+    std::vector<Endpoint> endpoints[2];     // X e Z
+    std::vector<uint32_t> endpoint_slot[2]; // Posição de cada extremo na lista, por Endpoint::data
+
+    // Por proxy
+    std::vector<glm::vec3> box_min;
+    std::vector<glm::vec3> box_max;
+    std::vector<uint32_t> user;
+    std::vector<uint8_t> alive;
+    std::vector<uint8_t> dirty;        // Moveu desde o último Update()
+    std::vector<uint32_t> pair_count;  // Pares no plano XZ; sem pares, a separação nem procura o par
+
+    std::vector<Proxy> free_proxies;
+    std::vector<Proxy> removed; // Desde o último Update()
+    std::vector<Proxy> moved;   // Desde o último Update()
+    size_t added;               // Desde o último Update()
+    size_t live;
+    size_t swaps;
+
+    // Pares no plano XZ: a lista densa para percorrer e a posição de cada um nela
+    std::vector<uint64_t> pairs;
+    std::unordered_map<uint64_t, uint32_t> pair_slot;
+};
+
+#endif // SWEEP_PRUNE_HPP
@@ -0,0 +1,182 @@
+#include "terrain.hpp"
+#include <algorithm>
+#include <cmath>
+#include "random.hpp"
+
+// Amplitude do relevo de cada bioma, em metros, na ordem dos chunks do mundo
+// (linha a linha a partir de -map_length). O bioma do centro, onde fica a
+// loja, é plano.
+static const float TILE_RELIEF[9] = {
+    2.0f, 3.0f, 2.5f,
+    1.5f, 0.0f, 2.0f,
+    4.0f, 0.5f, 0.75f
+};
+
+// Oitavas do ruído: comprimento de onda em metros e peso
+static const int TERRAIN_OCTAVES = 2;
+static const float OCTAVE_WAVELENGTH[TERRAIN_OCTAVES] = {48.0f, 16.0f};
+static const float OCTAVE_WEIGHT[TERRAIN_OCTAVES] = {1.0f, 0.35f};
+
+Terrain::Terrain() {
+    Resize(1.0f, 1.0f, 3, 3);
+}
+
+void Terrain::Resize(float map_width, float map_length, size_t column_count, size_t row_count) {
+    columns = column_count;
+    rows = row_count;
+    min_x = -map_width;
+    min_z = -map_length;
+    cell_x = 2.0f * map_width / columns;
+    cell_z = 2.0f * map_length / rows;
+    inverse_cell_x = 1.0f / cell_x;
+    inverse_cell_z = 1.0f / cell_z;
+    heights.assign((columns + 1) * (rows + 1), 0.0f);
+}
+
+//Células por lado: perto de TERRAIN_CELL_SIZE, múltiplo de 3 e no máximo TERRAIN_MAX_CELLS
+static size_t CellCount(float side) {
+    size_t tiles = (size_t)std::ceil(side / (3.0f * TERRAIN_CELL_SIZE));
+    return 3 * std::min(std::max(tiles, (size_t)1), (size_t)(TERRAIN_MAX_CELLS / 3));
+}
+
+static inline float SmoothStep(float t) {
+    return t * t * (3.0f - 2.0f * t);
+}
+
+// Ruído de valor em [-1, 1): valores sorteados nos cantos de uma grade de
+// "wavelength" metros, interpolados com suavização
+static float ValueNoise(uint64_t seed, int octave, float x, float z, float wavelength) {
+    float u = x / wavelength, v = z / wavelength;
+    float fu = std::floor(u), fv = std::floor(v);
+    // Deslocados para os cantos ficarem positivos; a oitava vai nos bits altos do id
+    uint32_t ix = (uint32_t)((int)fu + 32768) | (uint32_t)octave << 16;
+    uint32_t iz = (uint32_t)((int)fv + 32768);
+    float c00 = CounterUniform(seed, ix, iz, RNG_TERRAIN);
+    float c10 = CounterUniform(seed, ix + 1, iz, RNG_TERRAIN);
+    float c01 = CounterUniform(seed, ix, iz + 1, RNG_TERRAIN);
+    float c11 = CounterUniform(seed, ix + 1, iz + 1, RNG_TERRAIN);
+    float tu = SmoothStep(u - fu), tv = SmoothStep(v - fv);
+    float c0 = c00 + tu * (c10 - c00);
+    float c1 = c01 + tu * (c11 - c01);
+    return 2.0f * (c0 + tv * (c1 - c0)) - 1.0f;
+}
+
+// Amplitude no ponto, interpolada entre os centros dos biomas para o relevo
+// não ter degraus nas bordas
+static float TileRelief(float x, float z, float map_width, float map_length) {
+    float tile_width = 2.0f * map_width / 3.0f, tile_length = 2.0f * map_length / 3.0f;
+    float u = std::min(std::max((x + map_width) / tile_width - 0.5f, 0.0f), 2.0f);
+    float v = std::min(std::max((z + map_length) / tile_length - 0.5f, 0.0f), 2.0f);
+    int column = std::min((int)u, 1), row = std::min((int)v, 1);
+    float tu = u - column, tv = v - row;
+    float r0 = TILE_RELIEF[row * 3 + column] + tu * (TILE_RELIEF[row * 3 + column + 1] - TILE_RELIEF[row * 3 + column]);
+    float r1 = TILE_RELIEF[(row + 1) * 3 + column] + tu * (TILE_RELIEF[(row + 1) * 3 + column + 1] - TILE_RELIEF[(row + 1) * 3 + column]);
+    return r0 + tv * (r1 - r0);
+}
+
+void Terrain::Generate(uint64_t seed, float map_width, float map_length, float relief) {
+    Resize(map_width, map_length, CellCount(2.0f * map_width), CellCount(2.0f * map_length));
+    if (relief <= 0.0f) {
+        return;
+    }
+    for (size_t row = 0; row <= rows; row++) {
+        for (size_t column = 0; column <= columns; column++) {
+            glm::vec2 position = SamplePosition(column, row);
+            float noise = 0.0f;
+            for (int octave = 0; octave < TERRAIN_OCTAVES; octave++) {
+                noise += OCTAVE_WEIGHT[octave] * ValueNoise(seed, octave, position.x, position.y, OCTAVE_WAVELENGTH[octave]);
+            }
+            heights[row * (columns + 1) + column] = relief * TileRelief(position.x, position.y, map_width, map_length) * noise;
+        }
+    }
+}
+
+size_t Terrain::Columns() const {
+    return columns;
+}
+
+size_t Terrain::Rows() const {
+    return rows;
+}
+
+float Terrain::Sample(size_t column, size_t row) const {
+    return heights[row * (columns + 1) + column];
+}
+
+glm::vec2 Terrain::SamplePosition(size_t column, size_t row) const {
+    return glm::vec2(min_x + cell_x * column, min_z + cell_z * row);
+}
+
+//Mesmas operações de CellBlock(), na mesma ordem
+void Terrain::Cell(float x, float z, size_t& index, float& tx, float& tz) const {
+    float fx = std::fmin(std::fmax((x - min_x) * inverse_cell_x, 0.0f), float(columns));
+    float fz = std::fmin(std::fmax((z - min_z) * inverse_cell_z, 0.0f), float(rows));
+    float column = std::fmin(float(int(fx)), float(columns - 1));
+    float row = std::fmin(float(int(fz)), float(rows - 1));
+    tx = fx - column;
+    tz = fz - row;
+    index = (size_t)(row * float(columns + 1) + column);
+}
+
+float Terrain::Height(float x, float z) const {
+    size_t index;
+    float tx, tz;
+    Cell(x, z, index, tx, tz);
+    const float* h = &heights[index];
+    float h0 = h[0] + tx * (h[1] - h[0]);
+    float h1 = h[columns + 1] + tx * (h[columns + 2] - h[columns + 1]);
+    return h0 + tz * (h1 - h0);
+}
+
+// Gradiente da interpolação bilinear dentro da célula: dh/dx varia com tz e
+// dh/dz com tx
+glm::vec3 Terrain::Normal(float x, float z) const {
+    size_t index;
+    float tx, tz;
+    Cell(x, z, index, tx, tz);
+    const float* h = &heights[index];
+    float dx0 = h[1] - h[0], dx1 = h[columns + 2] - h[columns + 1];
+    float dz0 = h[columns + 1] - h[0], dz1 = h[columns + 2] - h[1];
+    float slope_x = (dx0 + tz * (dx1 - dx0)) * inverse_cell_x;
+    float slope_z = (dz0 + tx * (dz1 - dz0)) * inverse_cell_z;
+    float inverse_length = 1.0f / std::sqrt(slope_x * slope_x + 1.0f + slope_z * slope_z);
+    return glm::vec3(-slope_x * inverse_length, inverse_length, -slope_z * inverse_length);
+}
+
+void Terrain::Heights(const float* x, const float* z, float* out, size_t count) const {
+    size_t k = 0;
+#if defined(CREATURE_SIMD_AVX2) || defined(CREATURE_SIMD_SSE2)
+    for (; k + LANES <= count; k += LANES) {
+        VStore(out + k, HeightBlock(VLoad(x + k), VLoad(z + k)));
+    }
+#endif
+    for (; k < count; k++) {
+        out[k] = Height(x[k], z[k]);
+    }
+}
+
+void Terrain::Normals(const float* x, const float* z, glm::vec3* out, size_t count) const {
+    size_t k = 0;
+#if defined(CREATURE_SIMD_AVX2) || defined(CREATURE_SIMD_SSE2)
+    const vfloat one = VSet(1.0f);
+    for (; k + LANES <= count; k += LANES) {
+        vfloat tx, tz, h00, h10, h01, h11;
+        CellBlock(VLoad(x + k), VLoad(z + k), tx, tz, h00, h10, h01, h11);
+        vfloat dx0 = VSub(h10, h00), dx1 = VSub(h11, h01);
+        vfloat dz0 = VSub(h01, h00), dz1 = VSub(h11, h10);
+        vfloat slope_x = VMul(VAdd(dx0, VMul(tz, VSub(dx1, dx0))), VSet(inverse_cell_x));
+        vfloat slope_z = VMul(VAdd(dz0, VMul(tx, VSub(dz1, dz0))), VSet(inverse_cell_z));
+        vfloat inverse_length = VDiv(one, VSqrt(VAdd(VAdd(VMul(slope_x, slope_x), one), VMul(slope_z, slope_z))));
+        float nx[LANES], ny[LANES], nz[LANES];
+        VStore(nx, VMul(slope_x, inverse_length));
+        VStore(ny, inverse_length);
+        VStore(nz, VMul(slope_z, inverse_length));
+        for (size_t lane = 0; lane < LANES; lane++) {
+            out[k + lane] = glm::vec3(-nx[lane], ny[lane], -nz[lane]);
+        }
+    }
+#endif
+    for (; k < count; k++) {
+        out[k] = Normal(x[k], z[k]);
+    }
+}
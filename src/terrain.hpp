@@ -0,0 +1,86 @@
+#ifndef TERRAIN_HPP
+#define TERRAIN_HPP
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include "simd.hpp"
+
+#define TERRAIN_CELL_SIZE 2.0f  // Metros entre duas amostras de altura
+#define TERRAIN_MAX_CELLS 768   // Células por lado, no máximo (múltiplo de 3, para cada bioma ter as suas)
+#define TERRAIN_RELIEF 1.0f     // Escala padrão do relevo; 0 deixa o chão plano
+
+// Chão do mapa como uma grade de alturas, interpolada de forma bilinear. A
+// altura é medida a partir do chão plano antigo (Creature::GROUND_LEVEL para
+// os slimes, GROUND_LEVEL da câmera). Cada bioma tem o seu relevo, mas as
+// amostras ficam numa grade só, com as bordas dos biomas sobre linhas da
+// grade, então uma consulta não depende de em que bioma o ponto está e um
+// lote de pontos é respondido em blocos SIMD sem desvios. Fora do mapa vale
+// a altura da borda.
+class Terrain {
+public:
+    Terrain(); // Plano, até ser gerado
+
+    // Relevo do mapa [-map_width, map_width] x [-map_length, map_length],
+    // sempre o mesmo para a mesma seed. "relief" multiplica a altura de todos
+    // os biomas.
+    void Generate(uint64_t seed, float map_width, float map_length, float relief);
+
+    float Height(float x, float z) const;
+    glm::vec3 Normal(float x, float z) const; // Normal unitária da superfície interpolada
+
+    // Mesmas consultas para um lote de pontos: out[k] é a resposta de (x[k], z[k])
+    void Heights(const float* x, const float* z, float* out, size_t count) const;
+    void Normals(const float* x, const float* z, glm::vec3* out, size_t count) const;
+
+    // Amostras da grade, para montar a malha do chão
+    size_t Columns() const; // Células no eixo x; há Columns() + 1 amostras
+    size_t Rows() const;    // Células no eixo z
+    float Sample(size_t column, size_t row) const;
+    glm::vec2 SamplePosition(size_t column, size_t row) const;
+
+#if defined(CREATURE_SIMD_AVX2) || defined(CREATURE_SIMD_SSE2)
+    // Altura de LANES pontos de uma vez, igual bit a bit à de Height()
+    inline vfloat HeightBlock(vfloat x, vfloat z) const {
+        vfloat tx, tz, h00, h10, h01, h11;
+        CellBlock(x, z, tx, tz, h00, h10, h01, h11);
+        vfloat h0 = VAdd(h00, VMul(tx, VSub(h10, h00)));
+        vfloat h1 = VAdd(h01, VMul(tx, VSub(h11, h01)));
+        return VAdd(h0, VMul(tz, VSub(h1, h0)));
+    }
+#endif
+
+private:
+    void Resize(float map_width, float map_length, size_t columns, size_t rows);
+    // Célula do ponto e posição dentro dela, em [0, 1]
+    void Cell(float x, float z, size_t& index, float& tx, float& tz) const;
+
+#if defined(CREATURE_SIMD_AVX2) || defined(CREATURE_SIMD_SSE2)
+    inline void CellBlock(vfloat x, vfloat z, vfloat& tx, vfloat& tz, vfloat& h00, vfloat& h10, vfloat& h01, vfloat& h11) const {
+        const vfloat zero = VSet(0.0f);
+        vfloat fx = VMin(VMax(VMul(VSub(x, VSet(min_x)), VSet(inverse_cell_x)), zero), VSet(float(columns)));
+        vfloat fz = VMin(VMax(VMul(VSub(z, VSet(min_z)), VSet(inverse_cell_z)), zero), VSet(float(rows)));
+        vfloat column = VMin(VToFloat(VToInt(fx)), VSet(float(columns - 1)));
+        vfloat row = VMin(VToFloat(VToInt(fz)), VSet(float(rows - 1)));
+        tx = VSub(fx, column);
+        tz = VSub(fz, row);
+        // A grade tem no máximo (TERRAIN_MAX_CELLS + 1)² amostras, então o índice é exato em float
+        vint index = VToInt(VAdd(VMul(row, VSet(float(columns + 1))), column));
+        const float* base = &heights[0];
+        h00 = VGather(base, index);
+        h10 = VGather(base + 1, index);
+        h01 = VGather(base + columns + 1, index);
+        h11 = VGather(base + columns + 2, index);
+    }
+#endif
+
+    std::vector<float> heights; // (Rows() + 1) x (Columns() + 1), linha a linha
+    size_t columns, rows;
+    float min_x, min_z;
+    float cell_x, cell_z;
+    float inverse_cell_x, inverse_cell_z;
+};
+
+#endif // TERRAIN_HPP
@@ -0,0 +1,172 @@
+#include "timing_wheel.hpp"
+#include <algorithm>
+
+const uint32_t TimingWheel::NONE;
+const uint32_t TimingWheel::SLOTS;
+
+TimingWheel::TimingWheel() : now(0), head(WHEEL_LEVELS * SLOTS, NONE) {
+}
+
+size_t TimingWheel::Size() const {
+    return slot.size();
+}
+
+void TimingWheel::Reserve(size_t capacity) {
+    slot.reserve(capacity);
+    next.reserve(capacity);
+    prev.reserve(capacity);
+    due.reserve(capacity);
+}
+
+void TimingWheel::Clear() {
+    std::fill(head.begin(), head.end(), NONE);
+    slot.clear();
+    next.clear();
+    prev.clear();
+    due.clear();
+}
+
+void TimingWheel::ShrinkToFit() {
+    slot.shrink_to_fit();
+    next.shrink_to_fit();
+    prev.shrink_to_fit();
+    due.shrink_to_fit();
+}
+
+//Nível pela distância até o evento, posição pelos bits do tick daquele nível
+uint32_t TimingWheel::SlotFor(uint32_t tick) const {
+    uint32_t delta = tick - now;
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 && delta >= (1u << (WHEEL_SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    if (level == WHEEL_LEVELS - 1 && delta >= (1u << (WHEEL_SLOT_BITS * WHEEL_LEVELS)) - 1) {
+        // Além do alcance: fica na última posição e é redistribuído quando ela chegar
+        tick = now + (1u << (WHEEL_SLOT_BITS * WHEEL_LEVELS)) - 1;
+    }
+    return level * SLOTS + ((tick >> (WHEEL_SLOT_BITS * level)) & (SLOTS - 1));
+}
+
+void TimingWheel::Link(uint32_t item, uint32_t s) {
+    slot[item] = s;
+    prev[item] = NONE;
+    next[item] = head[s];
+    if (head[s] != NONE) {
+        prev[head[s]] = item;
+    }
+    head[s] = item;
+}
+
+void TimingWheel::Unlink(uint32_t item) {
+    if (prev[item] != NONE) {
+        next[prev[item]] = next[item];
+    } else {
+        head[slot[item]] = next[item];
+    }
+    if (next[item] != NONE) {
+        prev[next[item]] = prev[item];
+    }
+    slot[item] = NONE;
+}
+
+uint32_t TimingWheel::Insert() {
+    uint32_t item = (uint32_t)slot.size();
+    slot.push_back(NONE);
+    next.push_back(NONE);
+    prev.push_back(NONE);
+    due.push_back(0);
+    return item;
+}
+
+void TimingWheel::Remove(uint32_t item) {
+    uint32_t last = (uint32_t)slot.size() - 1;
+    if (slot[item] != NONE) {
+        Unlink(item);
+    }
+    if (item != last) {
+        // O último item assume o índice removido; os vizinhos passam a apontar para ele
+        slot[item] = slot[last];
+        next[item] = next[last];
+        prev[item] = prev[last];
+        due[item] = due[last];
+        if (slot[item] != NONE) {
+            if (prev[item] != NONE) {
+                next[prev[item]] = item;
+            } else {
+                head[slot[item]] = item;
+            }
+            if (next[item] != NONE) {
+                prev[next[item]] = item;
+            }
+        }
+    }
+    slot.pop_back();
+    next.pop_back();
+    prev.pop_back();
+    due.pop_back();
+}
+
+void TimingWheel::Schedule(uint32_t item, uint32_t tick) {
+    if (slot[item] != NONE) {
+        Unlink(item);
+    }
+    if ((int32_t)(tick - now) < 0) {
+        tick = now;
+    }
+    due[item] = tick;
+    Link(item, SlotFor(tick));
+}
+
+void TimingWheel::Cancel(uint32_t item) {
+    if (slot[item] != NONE) {
+        Unlink(item);
+    }
+}
+
+bool TimingWheel::Scheduled(uint32_t item) const {
+    return slot[item] != NONE;
+}
+
+uint32_t TimingWheel::Due(uint32_t item) const {
+    return due[item];
+}
+
+uint32_t TimingWheel::Now() const {
+    return now;
+}
+
+//Redistribui a posição atual de "level" pelos níveis de baixo
+void TimingWheel::Cascade(int level) {
+    uint32_t s = level * SLOTS + ((now >> (WHEEL_SLOT_BITS * level)) & (SLOTS - 1));
+    uint32_t item = head[s];
+    head[s] = NONE;
+    while (item != NONE) {
+        uint32_t following = next[item];
+        Link(item, SlotFor(due[item]));
+        item = following;
+    }
+}
+
+size_t TimingWheel::Advance(uint32_t tick, std::vector<uint32_t>& out) {
+    size_t fired = 0;
+    while ((int32_t)(tick - now) >= 0) {
+        // Ao virar uma volta de um nível, desce a posição correspondente do nível de cima
+        for (int level = WHEEL_LEVELS - 1; level > 0; level--) {
+            if ((now & ((1u << (WHEEL_SLOT_BITS * level)) - 1)) == 0) {
+                Cascade(level);
+            }
+        }
+        uint32_t s = now & (SLOTS - 1);
+        uint32_t item = head[s];
+        head[s] = NONE;
+        while (item != NONE) {
+            uint32_t following = next[item];
+            slot[item] = NONE;
+            out.push_back(item);
+            fired++;
+            item = following;
+        }
+        now++;
+    }
+    return fired;
+}
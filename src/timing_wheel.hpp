@@ -0,0 +1,61 @@
+#ifndef TIMING_WHEEL_HPP
+#define TIMING_WHEEL_HPP
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+#define WHEEL_LEVELS 4     // Cobre 64^4 ticks (mais de 77 horas a 60 ticks por segundo)
+#define WHEEL_SLOT_BITS 6  // 64 posições por nível
+
+// Agenda hierárquica de eventos por tick (timing wheel). O nível 0 tem uma
+// posição por tick; cada nível acima cobre 64 vezes mais ticks por posição
+// e é redistribuído para o nível de baixo quando o tempo chega nele. Agendar,
+// cancelar e disparar custam O(1), então cada tick só toca os itens que
+// vencem nele. Como a SpatialGrid, cada item é um índice denso (o mesmo do
+// CreaturePool) e cada posição guarda uma lista ligada dos seus itens.
+class TimingWheel {
+public:
+    TimingWheel();
+
+    size_t Size() const;
+    void Reserve(size_t capacity);
+    void Clear(); // Remove todos os itens; o tick atual continua o mesmo
+    void ShrinkToFit();
+
+    uint32_t Insert();  // Novo item, sem evento, recebe o índice Size()
+    // Remove "item" e move o último para o seu índice, como CreaturePool::Remove()
+    void Remove(uint32_t item);
+
+    // Agenda o evento de "item" para o tick "due" (substitui o anterior).
+    // Um tick que já passou vale como o próximo a disparar.
+    void Schedule(uint32_t item, uint32_t due);
+    void Cancel(uint32_t item);
+    bool Scheduled(uint32_t item) const;
+    uint32_t Due(uint32_t item) const;
+
+    // Avança até "tick" (inclusive), acrescentando a "out" os itens que
+    // venceram; eles deixam de estar agendados. Retorna quantos foram.
+    size_t Advance(uint32_t tick, std::vector<uint32_t>& out);
+    uint32_t Now() const; // Próximo tick a disparar
+
+private:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+    static const uint32_t SLOTS = 1u << WHEEL_SLOT_BITS;
+
+    uint32_t SlotFor(uint32_t due) const;
+    void Link(uint32_t item, uint32_t slot);
+    void Unlink(uint32_t item);
+    void Cascade(int level);
+
+    uint32_t now;
+    std::vector<uint32_t> head; // Primeiro item de cada posição, WHEEL_LEVELS * SLOTS
+
+    // Por item
+    std::vector<uint32_t> slot;
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> prev;
+    std::vector<uint32_t> due;
+};
+
+#endif // TIMING_WHEEL_HPP
@@ -0,0 +1,78 @@
+#include "world_commands.hpp"
+#include "miniaudio.h"
+
+void WorldCommands::Push(Kind kind, uint32_t value, ma_sound* sound, float volume, float pitch) {
+    Command command = {kind, value, sound, volume, pitch};
+    commands.push_back(command);
+}
+
+void WorldCommands::Spawn(uint32_t count) {
+    Push(COMMAND_SPAWN, count, NULL, 0.0f, 0.0f);
+}
+
+void WorldCommands::Despawn(CreatureHandle handle) {
+    Push(COMMAND_DESPAWN, handle, NULL, 0.0f, 0.0f);
+}
+
+void WorldCommands::AddToInventory(Slime_Type type) {
+    Push(COMMAND_ADD_TO_INVENTORY, (uint32_t)type, NULL, 0.0f, 0.0f);
+}
+
+void WorldCommands::DepositInventory() {
+    Push(COMMAND_DEPOSIT_INVENTORY, 0, NULL, 0.0f, 0.0f);
+}
+
+void WorldCommands::PlaySound(ma_sound* sound) {
+    Push(COMMAND_PLAY_SOUND, 0, sound, -1.0f, -1.0f);
+}
+
+void WorldCommands::PlaySound(ma_sound* sound, float volume) {
+    Push(COMMAND_PLAY_SOUND, 0, sound, volume, -1.0f);
+}
+
+void WorldCommands::PlaySound(ma_sound* sound, float volume, float pitch) {
+    Push(COMMAND_PLAY_SOUND, 0, sound, volume, pitch);
+}
+
+bool WorldCommands::Empty() const {
+    return commands.empty();
+}
+
+void WorldCommands::Clear() {
+    commands.clear();
+}
+
+size_t WorldCommands::Apply(CreatureWorld& world, float map_width, float map_length, std::vector<Slime_Type>& inventory, std::map<Slime_Type, int>& balance) {
+    size_t spawned = 0;
+    for (size_t k = 0; k < commands.size(); k++) {
+        const Command& command = commands[k];
+        switch (command.kind) {
+        case COMMAND_SPAWN:
+            spawned += SpawnCreatures(world, command.value, map_width, map_length);
+            break;
+        case COMMAND_DESPAWN:
+            world.Remove(command.value);
+            break;
+        case COMMAND_ADD_TO_INVENTORY:
+            inventory.push_back(Slime_Type(command.value));
+            break;
+        case COMMAND_DEPOSIT_INVENTORY:
+            for (size_t slime = 0; slime < inventory.size(); slime++) {
+                balance[inventory[slime]]++;
+            }
+            inventory.clear();
+            break;
+        case COMMAND_PLAY_SOUND:
+            if (command.volume >= 0.0f) {
+                ma_sound_set_volume(command.sound, command.volume);
+            }
+            if (command.pitch >= 0.0f) {
+                ma_sound_set_pitch(command.sound, command.pitch);
+            }
+            ma_sound_start(command.sound);
+            break;
+        }
+    }
+    commands.clear();
+    return spawned;
+}
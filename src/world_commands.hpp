@@ -0,0 +1,56 @@
+#ifndef WORLD_COMMANDS_HPP
+#define WORLD_COMMANDS_HPP
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include "creature_world.hpp"
+
+struct ma_sound;
+
+// Mudanças pedidas durante um tick do jogo (nascimentos, capturas, itens do
+// inventário e sons) guardadas em ordem e aplicadas juntas em Apply(), no fim
+// do tick. Quem percorre os slimes só grava comandos, então nenhum índice ou
+// chave muda no meio do laço e o laço pode ser dividido entre threads (um
+// buffer por thread, aplicados em sequência).
+class WorldCommands {
+public:
+    void Spawn(uint32_t count);          // "count" slimes de tipo sorteado, como SpawnCreatures()
+    void Despawn(CreatureHandle handle); // Ignorado se o slime já saiu
+    void AddToInventory(Slime_Type type);
+    void DepositInventory();             // Soma o inventário no saldo da loja e o esvazia
+    void PlaySound(ma_sound* sound);     // Com o volume e o pitch que o som já tem
+    void PlaySound(ma_sound* sound, float volume);
+    void PlaySound(ma_sound* sound, float volume, float pitch);
+
+    bool Empty() const;
+    void Clear();
+
+    // Aplica os comandos na ordem em que foram gravados e esvazia o buffer.
+    // Retorna quantos slimes nasceram.
+    size_t Apply(CreatureWorld& world, float map_width, float map_length, std::vector<Slime_Type>& inventory, std::map<Slime_Type, int>& balance);
+
+private:
+    enum Kind {
+        COMMAND_SPAWN,
+        COMMAND_DESPAWN,
+        COMMAND_ADD_TO_INVENTORY,
+        COMMAND_DEPOSIT_INVENTORY,
+        COMMAND_PLAY_SOUND
+    };
+
+    struct Command {
+        Kind kind;
+        uint32_t value;  // Quantidade, handle ou tipo de slime
+        ma_sound* sound;
+        float volume;    // Negativo mantém o volume do som
+        float pitch;     // Negativo mantém o pitch do som
+    };
+
+    void Push(Kind kind, uint32_t value, ma_sound* sound, float volume, float pitch);
+
+    std::vector<Command> commands;
+};
+
+#endif // WORLD_COMMANDS_HPP
@@ -0,0 +1,34 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <cstdio>
+#include <cstring>
+
+// Verificação dos testes: uma falha é reportada e contada, e o teste segue
+// até o fim para mostrar todas; CheckResult() vira o código de saída
+static int check_failures = 0;
+
+#define CHECK(condition, ...)                        \
+    do {                                             \
+        if (!(condition)) {                          \
+            fprintf(stderr, "ERROR: " __VA_ARGS__);  \
+            fprintf(stderr, "\n");                   \
+            check_failures++;                        \
+        }                                            \
+    } while (0)
+
+static inline int CheckResult(const char* name) {
+    if (check_failures > 0) {
+        fprintf(stderr, "%s: %d falha(s)\n", name, check_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+// Igualdade bit a bit, para floats que precisam sair idênticos
+static inline bool SameBits(float a, float b) {
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+#endif // CHECK_HPP
@@ -0,0 +1,102 @@
+// Separação dos slimes: slimes largados ao acaso, muitos a menos de
+// Creature::MIN_DISTANCE um do outro, precisam terminar sem nenhum par mais
+// perto que MIN_DISTANCE - SEPARATION_SLOP, com os capturados parados, e o
+// resultado com as cores resolvidas em paralelo precisa ser o mesmo, bit a
+// bit, que o de uma thread só.
+#include <cmath>
+#include "check.hpp"
+#include "creature_separation.hpp"
+#include "slime_types.hpp"
+
+static const float MAP_SIZE = 1000.0f;
+static const int TICKS = 120;
+
+struct Run {
+    CreatureWorld world;
+    std::vector<CreatureHandle> captured;
+    std::vector<glm::vec4> captured_at;
+    size_t first_overlapping;
+    size_t last_overlapping;
+
+    Run() : world(3), first_overlapping(0), last_overlapping(0) {}
+};
+
+static void Separate(Run& run, unsigned int workers) {
+    CreatureWorld& world = run.world;
+    world.SetMapSize(MAP_SIZE, MAP_SIZE);
+    uint32_t state = 99;
+    for (int k = 0; k < 12000; k++) {
+        state = state * 1664525u + 1013904223u;
+        float x = -400.0f + 800.0f * ((state >> 8) * (1.0f / 16777216.0f));
+        state = state * 1664525u + 1013904223u;
+        float z = -400.0f + 800.0f * ((state >> 8) * (1.0f / 16777216.0f));
+        CreatureHandle handle = world.Add(Slime_Type(k % SLIME_TYPE_COUNT), x, 0.0f, z);
+        if (k % 500 == 0) {
+            CreatureKey key = world.Find(handle);
+            world.Chunk(CreatureKeyChunk(key)).captured[CreatureKeyIndex(key)] = true;
+            run.captured.push_back(handle);
+            run.captured_at.push_back(world.GetPosition(handle));
+        }
+    }
+    JobSystem jobs(workers);
+    CreatureBroadPhase broad_phase;
+    BroadPhasePairs pairs;
+    CreatureSeparation separation;
+    for (int tick = 0; tick < TICKS; tick++) {
+        broad_phase.Sync(world);
+        broad_phase.GetPairs(pairs);
+        size_t overlapping = separation.Solve(jobs, world, pairs.slime_slimes);
+        if (tick == 0) {
+            run.first_overlapping = overlapping;
+        }
+        run.last_overlapping = overlapping;
+    }
+}
+
+// Menor distância no plano XZ entre dois slimes a menos de MIN_DISTANCE em cada eixo, por força bruta
+static float Closest(const CreatureWorld& world) {
+    std::vector<glm::vec2> points;
+    for (size_t c = 0; c < world.ChunkCount(); c++) {
+        const CreaturePool& pool = world.Chunk(c);
+        for (size_t i = 0; i < pool.Size(); i++) {
+            points.push_back(glm::vec2(pool.position_x[i], pool.position_z[i]));
+        }
+    }
+    float closest = INFINITY;
+    for (size_t a = 0; a < points.size(); a++) {
+        for (size_t b = a + 1; b < points.size(); b++) {
+            glm::vec2 d = points[a] - points[b];
+            if (std::fabs(d.x) < Creature::MIN_DISTANCE && std::fabs(d.y) < Creature::MIN_DISTANCE) {
+                closest = std::fmin(closest, glm::length(d));
+            }
+        }
+    }
+    return closest;
+}
+
+int main() {
+    Run serial;
+    Separate(serial, 0);
+    CHECK(serial.first_overlapping > 1000, "só %zu pares perto demais no começo, o teste não exercita a separação", serial.first_overlapping);
+    CHECK(serial.last_overlapping == 0, "%zu pares ainda perto demais depois de %d ticks", serial.last_overlapping, TICKS);
+    float closest = Closest(serial.world);
+    CHECK(closest >= Creature::MIN_DISTANCE - SEPARATION_SLOP - 1e-3f, "dois slimes terminaram a %g m um do outro", closest);
+    for (size_t k = 0; k < serial.captured.size(); k++) {
+        glm::vec4 position = serial.world.GetPosition(serial.captured[k]);
+        CHECK(position == serial.captured_at[k], "o slime capturado %u se moveu", serial.captured[k]);
+    }
+
+    Run parallel;
+    Separate(parallel, 4);
+    bool same = serial.world.Size() == parallel.world.Size();
+    for (size_t c = 0; same && c < serial.world.ChunkCount(); c++) {
+        const CreaturePool& a = serial.world.Chunk(c);
+        const CreaturePool& b = parallel.world.Chunk(c);
+        same = a.Size() == b.Size();
+        for (size_t i = 0; same && i < a.Size(); i++) {
+            same = a.handle[i] == b.handle[i] && SameBits(a.position_x[i], b.position_x[i]) && SameBits(a.position_z[i], b.position_z[i]);
+        }
+    }
+    CHECK(same, "a separação com 4 threads terminou diferente da serial");
+    return CheckResult("separation_test");
+}
@@ -0,0 +1,164 @@
+// Kernels em lote (blocos SIMD de simd.hpp) contra as versões escalares: os
+// testes de colisão em lote contra os de um par, as alturas e normais do
+// relevo em lote contra Height() e Normal(), o sorteio em lote contra
+// CounterUniform() e a física dos slimes em blocos contra a de um slime por
+// vez. Cada par precisa dar o mesmo resultado bit a bit, fora as normais,
+// que aceitam um erro de arredondamento.
+#include <cmath>
+#include "check.hpp"
+#include "collisions.hpp"
+#include "creature_update.hpp"
+#include "random.hpp"
+#include "terrain.hpp"
+
+static const float MAP_SIZE = 300.0f;
+
+static uint32_t state = 2024;
+
+static float Uniform(float min, float max) {
+    state = state * 1664525u + 1013904223u;
+    return min + (max - min) * ((state >> 8) * (1.0f / 16777216.0f));
+}
+
+static glm::vec3 RandomPoint(float range) {
+    return glm::vec3(Uniform(-range, range), Uniform(-range, range), Uniform(-range, range));
+}
+
+static void TestCollisions() {
+    // 1003 esferas: blocos inteiros e um resto, perto o bastante de tudo para haver acertos e erros
+    const size_t count = 1003;
+    SphereBatch a, b;
+    for (size_t k = 0; k < count; k++) {
+        a.Add(RandomPoint(5.0f), Uniform(0.1f, 2.0f));
+        b.Add(RandomPoint(5.0f), Uniform(0.1f, 2.0f));
+    }
+    std::vector<uint64_t> hits;
+
+    SphereSphereOverlapBatch(a, b, hits);
+    size_t overlapping = 0;
+    for (size_t k = 0; k < count; k++) {
+        bool single = CheckSphereSphereOverlap(glm::vec3(a.x[k], a.y[k], a.z[k]), a.radius[k], glm::vec3(b.x[k], b.y[k], b.z[k]), b.radius[k]);
+        CHECK(BatchHit(hits, k) == single, "esfera-esfera %zu: lote %d, escalar %d", k, BatchHit(hits, k), single);
+        overlapping += single;
+    }
+    CHECK(overlapping > 0 && overlapping < count, "esfera-esfera: %zu de %zu se sobrepõem, o teste não separa os casos", overlapping, count);
+
+    glm::vec3 center(0.5f, -0.25f, 1.0f);
+    SphereSphereOverlapBatch(center, 0.6f, b, hits);
+    for (size_t k = 0; k < count; k++) {
+        bool single = CheckSphereSphereOverlap(center, 0.6f, glm::vec3(b.x[k], b.y[k], b.z[k]), b.radius[k]);
+        CHECK(BatchHit(hits, k) == single, "esfera-esfera com centro fixo %zu: lote %d, escalar %d", k, BatchHit(hits, k), single);
+    }
+
+    glm::vec3 normal = glm::normalize(glm::vec3(0.3f, 0.0f, -1.0f));
+    SpherePlaneCollisionBatch(b, normal, 1.5f, hits);
+    for (size_t k = 0; k < count; k++) {
+        bool single = SpherePlaneCollision(glm::vec3(b.x[k], b.y[k], b.z[k]), b.radius[k], normal, 1.5f);
+        CHECK(BatchHit(hits, k) == single, "esfera-plano %zu: lote %d, escalar %d", k, BatchHit(hits, k), single);
+    }
+
+    glm::vec3 base(0.0f, -2.0f, 0.0f);
+    CylinderSphereCollisionBatch(base, 2.5f, 4.0f, b, hits);
+    for (size_t k = 0; k < count; k++) {
+        bool single = CylinderSphereCollision(base, 2.5f, 4.0f, glm::vec3(b.x[k], b.y[k], b.z[k]), b.radius[k]);
+        CHECK(BatchHit(hits, k) == single, "cilindro-esfera %zu: lote %d, escalar %d", k, BatchHit(hits, k), single);
+    }
+}
+
+static void TestTerrain(const Terrain& terrain) {
+    // Pontos também fora do mapa, onde vale a altura da borda
+    const size_t count = 4099;
+    std::vector<float> x(count), z(count), heights(count);
+    std::vector<glm::vec3> normals(count);
+    for (size_t k = 0; k < count; k++) {
+        x[k] = Uniform(-MAP_SIZE * 1.1f, MAP_SIZE * 1.1f);
+        z[k] = Uniform(-MAP_SIZE * 1.1f, MAP_SIZE * 1.1f);
+    }
+    terrain.Heights(&x[0], &z[0], &heights[0], count);
+    terrain.Normals(&x[0], &z[0], &normals[0], count);
+    for (size_t k = 0; k < count; k++) {
+        float height = terrain.Height(x[k], z[k]);
+        CHECK(SameBits(heights[k], height), "altura em (%g, %g): lote %.9g, escalar %.9g", x[k], z[k], heights[k], height);
+        glm::vec3 normal = terrain.Normal(x[k], z[k]);
+        CHECK(glm::length(normals[k] - normal) < 1e-6f, "normal em (%g, %g) diferente da escalar", x[k], z[k]);
+    }
+}
+
+static void TestCounterUniform() {
+    const size_t count = 517;
+    std::vector<uint32_t> ids(count);
+    std::vector<float> out(count);
+    for (size_t k = 0; k < count; k++) {
+        ids[k] = (uint32_t)(k * 7919u + 3u);
+    }
+    CounterUniformBatch(99, &ids[0], count, 1234, RNG_JUMP_ANGLE, &out[0]);
+    for (size_t k = 0; k < count; k++) {
+        CHECK(SameBits(out[k], CounterUniform(99, ids[k], 1234, RNG_JUMP_ANGLE)), "sorteio do id %u diferente do escalar", ids[k]);
+    }
+}
+
+// Pool com trechos de um tipo só e trechos misturados (os dois caminhos dos
+// blocos), slimes pulando, caindo, capturados e parados
+static void FillPool(CreaturePool& pool, const Terrain& terrain) {
+    pool.terrain = &terrain;
+    state = 77;
+    for (size_t i = 0; i < 203; i++) {
+        Slime_Type type = Slime_Type(i < 120 ? (i / 40) % SLIME_TYPE_COUNT : i % SLIME_TYPE_COUNT);
+        float x = Uniform(-MAP_SIZE, MAP_SIZE), z = Uniform(-MAP_SIZE, MAP_SIZE);
+        float y = i % 5 == 0 ? pool.GroundHeight(x, z) : pool.GroundHeight(x, z) + Uniform(0.0f, 3.0f);
+        pool.Add(type, x, y, z);
+        pool.Wake(i);
+        if (i % 3 == 0) {
+            pool.Jump(i);
+        }
+        if (i % 17 == 0) {
+            pool.captured[i] = true;
+        }
+        pool.target_rotation_angle[i] = Uniform(0.0f, glm::two_pi<float>());
+    }
+}
+
+template <typename T>
+static bool SameColumn(const std::vector<T>& a, const std::vector<T>& b) {
+    return a.size() == b.size() && (a.empty() || std::memcmp(&a[0], &b[0], a.size() * sizeof(T)) == 0);
+}
+
+static void TestCreatureUpdate(const Terrain& terrain) {
+    const float delta_t = 1.0f / 60.0f;
+    CreaturePool blocks(7), single(7);
+    FillPool(blocks, terrain);
+    FillPool(single, terrain);
+    std::vector<CreatureLanding> block_landings, single_landings;
+    size_t landed = 0;
+    for (int tick = 0; tick < 240; tick++) {
+        block_landings.clear();
+        single_landings.clear();
+        UpdateCreatureRange(blocks, delta_t, 0, blocks.Size(), block_landings);
+        // Intervalos de um slime nunca completam um bloco: tudo pela versão escalar
+        for (size_t i = 0; i < single.Size(); i++) {
+            UpdateCreatureRange(single, delta_t, i, i + 1, single_landings);
+        }
+        bool same_landings = block_landings.size() == single_landings.size();
+        for (size_t k = 0; same_landings && k < block_landings.size(); k++) {
+            same_landings = block_landings[k].creature == single_landings[k].creature && block_landings[k].tick == single_landings[k].tick;
+        }
+        CHECK(same_landings, "tick %d: %zu pousos em blocos, %zu escalares", tick, block_landings.size(), single_landings.size());
+        landed += block_landings.size();
+        bool same = SameColumn(blocks.position_x, single.position_x) && SameColumn(blocks.position_y, single.position_y) &&
+                    SameColumn(blocks.position_z, single.position_z) && SameColumn(blocks.vertical_velocity, single.vertical_velocity) &&
+                    SameColumn(blocks.rotation_angle, single.rotation_angle) && SameColumn(blocks.is_jumping, single.is_jumping) &&
+                    SameColumn(blocks.awake, single.awake);
+        CHECK(same, "tick %d: estado dos slimes em blocos diferente do escalar", tick);
+    }
+    CHECK(landed > 0, "nenhum slime pousou, o teste não passa pelos pousos");
+}
+
+int main() {
+    Terrain terrain;
+    terrain.Generate(7, MAP_SIZE, MAP_SIZE, TERRAIN_RELIEF);
+    TestCollisions();
+    TestTerrain(terrain);
+    TestCounterUniform();
+    TestCreatureUpdate(terrain);
+    return CheckResult("simd_batch_test");
+}
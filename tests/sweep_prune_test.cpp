@@ -0,0 +1,178 @@
+// Sweep and prune incremental contra a reconstrução e a força bruta: depois
+// de cada Update() os pares mantidos pelas trocas de extremos precisam ser os
+// de um SweepAndPrune montado do zero com as mesmas caixas (Rebuild()) e os
+// de testar todos os pares. CreatureBroadPhase, que só lê o registro de
+// mudanças do mundo, precisa achar os mesmos pares de slimes que a força bruta.
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <set>
+#include "check.hpp"
+#include "creature_broad_phase.hpp"
+#include "slime_types.hpp"
+#include "sweep_prune.hpp"
+
+typedef std::set<std::pair<uint32_t, uint32_t> > UserPairs;
+
+static uint32_t state = 12345;
+
+// Gerador próprio, para o teste não depender de rand()
+static float Uniform() {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+// Coordenadas em múltiplos de 0.25, para haver extremos empatados
+static float Snap(float value) {
+    return std::floor(value * 4.0f) * 0.25f;
+}
+
+struct Box {
+    glm::vec3 min, max;
+    bool alive;
+};
+
+static Box RandomBox() {
+    glm::vec3 center(Snap(Uniform() * 100.0f), Snap(Uniform() * 4.0f), Snap(Uniform() * 100.0f));
+    glm::vec3 half(Snap(0.5f + Uniform() * 2.0f));
+    Box box = {center - half, center + half, true};
+    return box;
+}
+
+static void AddUserPair(UserPairs& out, uint32_t a, uint32_t b) {
+    out.insert(std::make_pair(std::min(a, b), std::max(a, b)));
+}
+
+static UserPairs PairsOf(const SweepAndPrune& sweep) {
+    std::vector<SweepAndPrune::Pair> pairs;
+    sweep.GetPairs(pairs);
+    UserPairs out;
+    for (size_t k = 0; k < pairs.size(); k++) {
+        AddUserPair(out, sweep.User(pairs[k].first), sweep.User(pairs[k].second));
+    }
+    return out;
+}
+
+static bool Overlap(const Box& a, const Box& b) {
+    return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y &&
+           a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+static void TestSweepAndPrune() {
+    std::vector<Box> boxes;
+    std::vector<SweepAndPrune::Proxy> proxies;
+    SweepAndPrune sweep;
+    for (uint32_t k = 0; k < 1000; k++) {
+        boxes.push_back(RandomBox());
+        proxies.push_back(sweep.Add(boxes[k].min, boxes[k].max, k));
+    }
+    for (int step = 0; step < 200; step++) {
+        for (uint32_t k = 0; k < boxes.size(); k++) {
+            if (!boxes[k].alive) {
+                continue;
+            }
+            float roll = Uniform();
+            if (roll < 0.3f) {
+                // Passo curto, como o de um slime em um tick
+                glm::vec3 move(Snap(Uniform() * 1.0f - 0.5f), 0.0f, Snap(Uniform() * 1.0f - 0.5f));
+                boxes[k].min += move;
+                boxes[k].max += move;
+                sweep.Move(proxies[k], boxes[k].min, boxes[k].max);
+            } else if (roll < 0.302f) {
+                boxes[k] = RandomBox();
+                sweep.Move(proxies[k], boxes[k].min, boxes[k].max);
+            } else if (roll < 0.305f) {
+                boxes[k].alive = false;
+                sweep.Remove(proxies[k]);
+            }
+        }
+        for (int k = 0; k < 3; k++) {
+            boxes.push_back(RandomBox());
+            proxies.push_back(sweep.Add(boxes.back().min, boxes.back().max, (uint32_t)boxes.size() - 1));
+        }
+        sweep.Update();
+
+        SweepAndPrune rebuilt;
+        UserPairs brute;
+        for (uint32_t a = 0; a < boxes.size(); a++) {
+            if (!boxes[a].alive) {
+                continue;
+            }
+            rebuilt.Add(boxes[a].min, boxes[a].max, a);
+            for (uint32_t b = a + 1; b < boxes.size(); b++) {
+                if (boxes[b].alive && Overlap(boxes[a], boxes[b])) {
+                    AddUserPair(brute, a, b);
+                }
+            }
+        }
+        rebuilt.Update();
+
+        UserPairs incremental = PairsOf(sweep);
+        CHECK(incremental == PairsOf(rebuilt), "passo %d: %zu pares incrementais, %zu reconstruídos", step, incremental.size(), PairsOf(rebuilt).size());
+        CHECK(incremental == brute, "passo %d: %zu pares incrementais, %zu por força bruta", step, incremental.size(), brute.size());
+        CHECK(sweep.Size() == rebuilt.Size(), "passo %d: %zu caixas contra %zu", step, sweep.Size(), rebuilt.Size());
+    }
+}
+
+static void TestCreatureBroadPhase() {
+    const float map_size = 60.0f;
+    const float delta_t = 1.0f / 60.0f;
+    CreatureWorld world(5);
+    world.SetMapSize(map_size, map_size);
+    JobSystem jobs(0);
+    CreatureLod lod = {true, glm::vec3(0.0f), 30.0f, 5};
+    CreatureFlock flock = MakeCreatureFlock(false, map_size, map_size);
+    InitialCreatureSpawn(world, 400, map_size, map_size);
+    CreatureBroadPhase broad_phase;
+    BroadPhasePairs pairs;
+    for (int tick = 0; tick < 300; tick++) {
+        world.Update(jobs, delta_t, glm::vec3(0.0f), 50.0f, lod, flock);
+        if (tick % 7 == 0) {
+            for (int k = 0; k < 20; k++) {
+                world.Add(Slime_Type(k % SLIME_TYPE_COUNT), Uniform() * 2.0f * map_size - map_size, 0.0f, Uniform() * 2.0f * map_size - map_size);
+            }
+        }
+        if (tick % 5 == 0) {
+            for (size_t c = 0; c < world.ChunkCount(); c++) {
+                if (world.Chunk(c).Size() > 0) {
+                    world.Remove(world.Chunk(c).handle[tick % world.Chunk(c).Size()]);
+                }
+            }
+        }
+        if (tick == 150) {
+            world.CatchUp(30.0f, delta_t);
+        }
+        broad_phase.Sync(world);
+        broad_phase.GetPairs(pairs);
+
+        UserPairs found;
+        for (size_t k = 0; k < pairs.slime_slimes.size(); k++) {
+            AddUserPair(found, pairs.slime_slimes[k].first, pairs.slime_slimes[k].second);
+        }
+        std::vector<CreatureHandle> handles;
+        std::vector<glm::vec3> centers;
+        for (size_t c = 0; c < world.ChunkCount(); c++) {
+            const CreaturePool& pool = world.Chunk(c);
+            for (size_t i = 0; i < pool.Size(); i++) {
+                handles.push_back(pool.handle[i]);
+                centers.push_back(glm::vec3(pool.position_x[i], pool.position_y[i], pool.position_z[i]));
+            }
+        }
+        UserPairs brute;
+        for (size_t a = 0; a < handles.size(); a++) {
+            for (size_t b = a + 1; b < handles.size(); b++) {
+                glm::vec3 d = glm::abs(centers[a] - centers[b]);
+                if (d.x <= CREATURE_BOX_SIZE && d.y <= CREATURE_BOX_SIZE && d.z <= CREATURE_BOX_SIZE) {
+                    AddUserPair(brute, handles[a], handles[b]);
+                }
+            }
+        }
+        CHECK(found == brute, "tick %d: %zu pares de slimes na broad phase, %zu por força bruta", tick, found.size(), brute.size());
+    }
+}
+
+int main() {
+    TestSweepAndPrune();
+    TestCreatureBroadPhase();
+    return CheckResult("sweep_prune_test");
+}
@@ -0,0 +1,90 @@
+// Atualização do mundo em série e em paralelo: com 0, 2 e 4 threads do
+// JobSystem os slimes precisam terminar no mesmo estado, bit a bit, e o pulo
+// mais alto de cada tick precisa ser o mesmo.
+#include "check.hpp"
+#include "creature_update.hpp"
+#include "creature_world.hpp"
+#include "slime_types.hpp"
+#include "terrain.hpp"
+
+static const float MAP_SIZE = 300.0f;
+static const float DELTA_T = 1.0f / 60.0f;
+static const int TICKS = 600;
+
+struct Run {
+    CreatureWorld world;
+    std::vector<LoudestJump> loudest;
+
+    Run() : world(42) {}
+};
+
+// Mesmo rancho, com relevo, LOD e bando ligados, e slimes nascendo e sendo
+// movidos durante a partida
+static void Simulate(Run& run, const Terrain& terrain, unsigned int workers) {
+    JobSystem jobs(workers);
+    CreatureWorld& world = run.world;
+    world.SetMapSize(MAP_SIZE, MAP_SIZE);
+    world.SetTerrain(&terrain);
+    InitialCreatureSpawn(world, 3000, MAP_SIZE, MAP_SIZE);
+    CreatureLod lod = {true, glm::vec3(0.0f), CREATURE_LOD_NEAR_DISTANCE, CREATURE_LOD_BUCKETS};
+    CreatureFlock flock = MakeCreatureFlock(true, MAP_SIZE, MAP_SIZE);
+    for (int tick = 0; tick < TICKS; tick++) {
+        world.SaveRenderState();
+        lod.center = glm::vec3(-200.0f + tick * 0.5f, 0.0f, 100.0f);
+        run.loudest.push_back(world.Update(jobs, DELTA_T, lod.center, 50.0f, lod, flock));
+        if (tick % 10 == 0) {
+            SpawnCreatures(world, 25, MAP_SIZE, MAP_SIZE);
+        }
+        if (tick % 50 == 0) {
+            // Um slime de cada chunk atravessa o mapa, e troca de chunk
+            for (size_t c = 0; c < world.ChunkCount(); c++) {
+                CreaturePool& pool = world.Chunk(c);
+                if (pool.Size() > 0) {
+                    pool.SetPosition(tick % pool.Size(), glm::vec4(-pool.position_x[0], 0.0f, -pool.position_z[0], 1.0f));
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+static bool SameColumn(const std::vector<T>& a, const std::vector<T>& b) {
+    return a.size() == b.size() && (a.empty() || std::memcmp(&a[0], &b[0], a.size() * sizeof(T)) == 0);
+}
+
+static void Compare(const Run& serial, const Run& parallel, unsigned int workers) {
+    for (size_t t = 0; t < serial.loudest.size(); t++) {
+        const LoudestJump& a = serial.loudest[t];
+        const LoudestJump& b = parallel.loudest[t];
+        CHECK(a.creature == b.creature && a.chunk == b.chunk && a.handle == b.handle && SameBits(a.volume, b.volume),
+              "%u threads: pulo mais alto diferente no tick %zu", workers, t);
+    }
+    CHECK(serial.world.Size() == parallel.world.Size(), "%u threads: %zu slimes contra %zu", workers, parallel.world.Size(), serial.world.Size());
+    for (size_t c = 0; c < serial.world.ChunkCount(); c++) {
+        const CreaturePool& a = serial.world.Chunk(c);
+        const CreaturePool& b = parallel.world.Chunk(c);
+        bool same = a.tick == b.tick && SameColumn(a.id, b.id) && SameColumn(a.handle, b.handle) &&
+                    SameColumn(a.position_x, b.position_x) && SameColumn(a.position_y, b.position_y) &&
+                    SameColumn(a.position_z, b.position_z) && SameColumn(a.vertical_velocity, b.vertical_velocity) &&
+                    SameColumn(a.rotation_angle, b.rotation_angle) && SameColumn(a.target_rotation_angle, b.target_rotation_angle) &&
+                    SameColumn(a.is_jumping, b.is_jumping) && SameColumn(a.awake, b.awake) && SameColumn(a.sim_tick, b.sim_tick);
+        CHECK(same, "%u threads: estado do chunk %zu diferente do serial", workers, c);
+    }
+}
+
+int main() {
+    Terrain terrain;
+    terrain.Generate(42, MAP_SIZE, MAP_SIZE, TERRAIN_RELIEF);
+
+    Run serial;
+    Simulate(serial, terrain, 0);
+    CHECK(serial.world.Size() > 3000, "a simulação de referência ficou com %zu slimes", serial.world.Size());
+
+    const unsigned int workers[] = {2, 4};
+    for (size_t k = 0; k < sizeof(workers) / sizeof(workers[0]); k++) {
+        Run parallel;
+        Simulate(parallel, terrain, workers[k]);
+        Compare(serial, parallel, workers[k]);
+    }
+    return CheckResult("world_update_test");
+}